@@ -30,7 +30,7 @@ static void move_hiker_func(character *c, pair_t dest)
   int base;
   int i;
 
-  base = rand() & 0x7;
+  base = rng_u32(&rng[rng_npc]) >> 29;
 
   dest[dim_x] = c->pos[dim_x];
   dest[dim_y] = c->pos[dim_y];
@@ -61,7 +61,7 @@ static void move_rival_func(character *c, pair_t dest)
   int base;
   int i;
   
-  base = rand() & 0x7;
+  base = rng_u32(&rng[rng_npc]) >> 29;
 
   dest[dim_x] = c->pos[dim_x];
   dest[dim_y] = c->pos[dim_y];
@@ -142,7 +142,7 @@ static void move_wanderer_func(character *c, pair_t dest)
        world.cur_map->map[n->pos[dim_y]][n->pos[dim_x]]) ||
       world.cur_map->cmap[n->pos[dim_y] + n->dir[dim_y]]
                          [n->pos[dim_x] + n->dir[dim_x]]) {
-    rand_dir(n->dir);
+    rand_dir(&rng[rng_npc], n->dir);
   }
 
   if ((world.cur_map->map[n->pos[dim_y] + n->dir[dim_y]]
@@ -221,6 +221,25 @@ int32_t cmp_char_turns(const void *key, const void *with)
   return ((character *) key)->next_turn - ((character *) with)->next_turn;
 }
 
+int32_t char_turn_key(const void *v)
+{
+  return ((character *) v)->next_turn;
+}
+
+int32_t max_move_cost(character_type_t c)
+{
+  int32_t max;
+  int t;
+
+  for (max = 0, t = 0; t < num_terrain_types; t++) {
+    if (move_cost[c][t] != INT_MAX && move_cost[c][t] > max) {
+      max = move_cost[c][t];
+    }
+  }
+
+  return max;
+}
+
 void delete_character(void *v)
 {
   if (v != &world.pc) {
@@ -244,6 +263,51 @@ static int32_t rival_cmp(const void *key, const void *with) {
                           [((path_t *) with)->pos[dim_x]]);
 }
 
+static int32_t hiker_key(const void *v) {
+  return world.hiker_dist[((path_t *) v)->pos[dim_y]]
+                         [((path_t *) v)->pos[dim_x]];
+}
+
+static int32_t rival_key(const void *v) {
+  return world.rival_dist[((path_t *) v)->pos[dim_y]]
+                         [((path_t *) v)->pos[dim_x]];
+}
+
+/* Puts every cell that a character of type c can stand on into h, *
+ * in one go, and clears the nodes of the rest.  Every step costs a  *
+ * small integer, so h is a bucket queue on key unless c's moves     *
+ * have grown too dear for one; then it's a heap on cmp.             */
+static void pathfind_build(map_t *m, heap_t *h, path_t p[MAP_Y][MAP_X],
+                           character_type_t c,
+                           int32_t (*key)(const void *v),
+                           int32_t (*cmp)(const void *key, const void *with))
+{
+  static void *items[(MAP_Y - 2) * (MAP_X - 2)];
+  static heap_node_t *nodes[(MAP_Y - 2) * (MAP_X - 2)];
+  uint32_t x, y, i, n;
+
+  if (max_move_cost(c) < QUEUE_MAX_BUCKETS) {
+    heap_init_buckets(h, max_move_cost(c), key, NULL);
+  } else {
+    heap_init_dary(h, PATH_HEAP_ARITY, cmp, NULL);
+  }
+  heap_set_arena(h, &world.path_arena);
+
+  for (n = 0, y = 1; y < MAP_Y - 1; y++) {
+    for (x = 1; x < MAP_X - 1; x++) {
+      if (ter_cost(x, y, c) != INT_MAX) {
+        items[n++] = &p[y][x];
+      } else {
+        p[y][x].hn = NULL;
+      }
+    }
+  }
+  heap_build(h, items, n, nodes);
+  for (i = 0; i < n; i++) {
+    ((path_t *) items[i])->hn = nodes[i];
+  }
+}
+
 void pathfind(map_t *m)
 {
   heap_t h;
@@ -269,20 +333,14 @@ void pathfind(map_t *m)
   world.hiker_dist[world.pc.pos[dim_y]][world.pc.pos[dim_x]] = 
     world.rival_dist[world.pc.pos[dim_y]][world.pc.pos[dim_x]] = 0;
 
-  heap_init(&h, hiker_cmp, NULL);
-
-  for (y = 1; y < MAP_Y - 1; y++) {
-    for (x = 1; x < MAP_X - 1; x++) {
-      if (ter_cost(x, y, char_hiker) != INT_MAX) {
-        p[y][x].hn = heap_insert(&h, &p[y][x]);
-      } else {
-        p[y][x].hn = NULL;
-      }
-    }
-  }
+  pathfind_build(m, &h, p, char_hiker, hiker_key, hiker_cmp);
 
   while ((c = (path_t *) heap_remove_min(&h))) {
     c->hn = NULL;
+    // Whatever's left can't be reached.
+    if (world.hiker_dist[c->pos[dim_y]][c->pos[dim_x]] == INT_MAX) {
+      break;
+    }
     if ((p[c->pos[dim_y] - 1][c->pos[dim_x] - 1].hn) &&
         (world.hiker_dist[c->pos[dim_y] - 1][c->pos[dim_x] - 1] >
          world.hiker_dist[c->pos[dim_y]][c->pos[dim_x]] +
@@ -366,20 +424,13 @@ void pathfind(map_t *m)
   }
   heap_delete(&h);
 
-  heap_init(&h, rival_cmp, NULL);
-
-  for (y = 1; y < MAP_Y - 1; y++) {
-    for (x = 1; x < MAP_X - 1; x++) {
-      if (ter_cost(x, y, char_rival) != INT_MAX) {
-        p[y][x].hn = heap_insert(&h, &p[y][x]);
-      } else {
-        p[y][x].hn = NULL;
-      }
-    }
-  }
+  pathfind_build(m, &h, p, char_rival, rival_key, rival_cmp);
 
   while ((c = (path_t *) heap_remove_min(&h))) {
     c->hn = NULL;
+    if (world.rival_dist[c->pos[dim_y]][c->pos[dim_x]] == INT_MAX) {
+      break;
+    }
     if ((p[c->pos[dim_y] - 1][c->pos[dim_x] - 1].hn) &&
         (world.rival_dist[c->pos[dim_y] - 1][c->pos[dim_x] - 1] >
          world.rival_dist[c->pos[dim_y]][c->pos[dim_x]] +
@@ -0,0 +1,357 @@
+#include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+#endif
+
+#include "csv.h"
+
+static uint64_t csv_scan64_scalar(const char *p)
+{
+  uint64_t mask;
+  int i;
+
+  for (mask = 0, i = 0; i < 64; i++) {
+    if (p[i] == ',' || p[i] == '\n') {
+      mask |= 1ULL << i;
+    }
+  }
+
+  return mask;
+}
+
+uint64_t csv_scan_tail(const char *p, const char *end)
+{
+  uint64_t mask;
+  int i;
+
+  for (mask = 0, i = 0; p + i < end; i++) {
+    if (p[i] == ',' || p[i] == '\n') {
+      mask |= 1ULL << i;
+    }
+  }
+
+  return mask;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__ ((target ("sse2")))
+static uint64_t csv_scan64_sse2(const char *p)
+{
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i newline = _mm_set1_epi8('\n');
+  __m128i v;
+  uint64_t mask;
+  int i;
+
+  for (mask = 0, i = 0; i < 4; i++) {
+    v = _mm_loadu_si128((const __m128i *) (p + i * 16));
+    mask |= ((uint64_t) (uint16_t)
+             _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, comma),
+                                            _mm_cmpeq_epi8(v, newline)))
+             << (i * 16));
+  }
+
+  return mask;
+}
+
+__attribute__ ((target ("avx2")))
+static uint64_t csv_scan64_avx2(const char *p)
+{
+  const __m256i comma = _mm256_set1_epi8(',');
+  const __m256i newline = _mm256_set1_epi8('\n');
+  __m256i lo, hi;
+
+  lo = _mm256_loadu_si256((const __m256i *) p);
+  hi = _mm256_loadu_si256((const __m256i *) (p + 32));
+
+  return (((uint64_t) (uint32_t)
+           _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(lo, comma),
+                                                _mm256_cmpeq_epi8(lo,
+                                                                  newline)))) |
+          ((uint64_t) (uint32_t)
+           _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(hi, comma),
+                                                _mm256_cmpeq_epi8(hi,
+                                                                  newline))))
+          << 32);
+}
+
+#endif
+
+static uint64_t (*csv_pick_scanner())(const char *)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  // Static initializers can run before libgcc has looked at the CPU.
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return csv_scan64_avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return csv_scan64_sse2;
+  }
+#endif
+
+  return csv_scan64_scalar;
+}
+
+uint64_t (*csv_scan64)(const char *p) = csv_pick_scanner();
+
+bool csv_open(csv_file_t *f, const char *path)
+{
+  struct stat buf;
+  void *data;
+  int fd;
+
+  f->data = NULL;
+  f->size = 0;
+  csv_set_range(f, NULL, NULL);
+
+  if ((fd = open(path, O_RDONLY)) < 0) {
+    return false;
+  }
+  if (fstat(fd, &buf)) {
+    close(fd);
+    return false;
+  }
+  if (buf.st_size) {
+    data = mmap(NULL, buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+    // We make exactly one forward pass over every file.
+    madvise(data, buf.st_size, MADV_SEQUENTIAL);
+    f->data = (const char *) data;
+    f->size = buf.st_size;
+    csv_set_range(f, f->data, f->data + f->size);
+  }
+  close(fd);
+
+  return true;
+}
+
+void csv_close(csv_file_t *f)
+{
+  if (f->data) {
+    munmap((void *) f->data, f->size);
+  }
+  f->data = NULL;
+  f->size = 0;
+  csv_set_range(f, NULL, NULL);
+}
+
+const char csv_digit_pairs[201] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+bool csv_create(csv_writer_t *w, const char *path)
+{
+  w->len = 0;
+  w->ok = true;
+  if ((w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+    return false;
+  }
+  if (!(w->buf = (char *) malloc(CSV_WRITE_BUFFER))) {
+    close(w->fd);
+    return false;
+  }
+
+  return true;
+}
+
+void csv_flush(csv_writer_t *w)
+{
+  const char *p;
+  ssize_t n;
+
+  for (p = w->buf; w->ok && p < w->buf + w->len; p += n) {
+    if ((n = write(w->fd, p, w->buf + w->len - p)) < 0) {
+      if (errno != EINTR) {
+        w->ok = false;
+      }
+      n = 0;
+    }
+  }
+  w->len = 0;
+}
+
+bool csv_finish(csv_writer_t *w)
+{
+  csv_flush(w);
+  free(w->buf);
+  if (close(w->fd)) {
+    w->ok = false;
+  }
+
+  return w->ok;
+}
+
+#ifdef BENCHMARK
+
+/* Compares delimiter scanners against the loader this module replaced *
+ * on a real pokemon_moves.csv:                                        *
+ *                                                                     *
+ *   g++ -O2 -DBENCHMARK csv.cpp -o csv_bench                          *
+ *   ./csv_bench [path/to/pokemon_moves.csv]                           */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+/* The tokenizer db_parse() used until the CSVs were mapped. */
+static char *next_token(char *start, char delim)
+{
+  int i;
+  static char *s;
+
+  if (start) {
+    s = start;
+  }
+
+  start = s;
+
+  for (i = 0; s[i] && s[i] != delim; i++)
+    ;
+  s[i] = '\0';
+  s = s + i + 1;
+
+  return start;
+}
+
+static double now()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long bench_next_token(const char *path)
+{
+  FILE *f;
+  char line[800];
+  char *tmp;
+  long sum;
+  int i;
+
+  f = fopen(path, "r");
+  fgets(line, 800, f);
+  for (sum = 0; fgets(line, 800, f);) {
+    tmp = next_token(line, ',');
+    for (i = 0; i < 6; i++, tmp = next_token(NULL, ',')) {
+      sum += *tmp ? atoi(tmp) : 0;
+    }
+  }
+  fclose(f);
+
+  return sum;
+}
+
+static long bench_csv(const char *path)
+{
+  csv_file_t f;
+  long sum;
+  int i;
+
+  csv_open(&f, path);
+  csv_skip_line(&f);
+  for (sum = 0; !csv_eof(&f);) {
+    for (i = 0; i < 6; i++) {
+      sum += csv_int(&f, 0);
+    }
+  }
+  csv_close(&f);
+
+  return sum;
+}
+
+/* Just the scan, emitting field offsets, without parsing anything. */
+static long bench_offsets(const char *path)
+{
+  static uint32_t offset[1 << 16];
+  const char *p;
+  csv_file_t f;
+  uint64_t mask;
+  long n, count;
+
+  csv_open(&f, path);
+  for (count = n = 0, p = f.data; p < f.end; p += 64) {
+    for (mask = (f.end - p >= 64) ? csv_scan64(p) : csv_scan_tail(p, f.end);
+         mask; mask &= mask - 1) {
+      offset[n++ & 0xffff] = (p - f.data) + __builtin_ctzll(mask);
+    }
+    count += n;
+    n = 0;
+  }
+  csv_close(&f);
+
+  return count + offset[0];
+}
+
+static void run(const char *name, long (*func)(const char *),
+                const char *path, size_t size)
+{
+  double start, best;
+  long result;
+  int i;
+
+  for (best = 1e9, i = 0; i < 5; i++) {
+    start = now();
+    result = func(path);
+    if (now() - start < best) {
+      best = now() - start;
+    }
+  }
+  printf("%-24s %8.2f ms %8.1f MB/s  (%ld)\n",
+         name, best * 1000, size / best / 1e6, result);
+}
+
+int main(int argc, char *argv[])
+{
+  uint64_t (*picked)(const char *) = csv_scan64;
+  char path[4096];
+  struct stat buf;
+
+  if (argc == 2) {
+    snprintf(path, sizeof (path), "%s", argv[1]);
+  } else {
+    snprintf(path, sizeof (path),
+             "%s/.poke327/pokedex/pokedex/data/csv/pokemon_moves.csv",
+             getenv("HOME"));
+  }
+  if (stat(path, &buf)) {
+    perror(path);
+    return 1;
+  }
+
+  run("fgets + next_token", bench_next_token, path, buf.st_size);
+
+  csv_scan64 = csv_scan64_scalar;
+  run("scalar offsets", bench_offsets, path, buf.st_size);
+  run("scalar parse", bench_csv, path, buf.st_size);
+#if defined(__x86_64__) || defined(__i386__)
+  csv_scan64 = csv_scan64_sse2;
+  run("sse2 offsets", bench_offsets, path, buf.st_size);
+  run("sse2 parse", bench_csv, path, buf.st_size);
+  if (__builtin_cpu_supports("avx2")) {
+    csv_scan64 = csv_scan64_avx2;
+    run("avx2 offsets", bench_offsets, path, buf.st_size);
+    run("avx2 parse", bench_csv, path, buf.st_size);
+  }
+#endif
+  csv_scan64 = picked;
+
+  return 0;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef CSV_H
+# define CSV_H
+
+# include <cstddef>
+# include <cstdint>
+# include <cstring>
+# include <climits>
+
+/* A CSV file mapped into memory and walked in place.  Nothing is copied *
+ * except the identifiers that the tables store as strings.  Every field *
+ * reader consumes the field and its trailing delimiter (',' or the end  *
+ * of the line), so rows are read by calling them in column order.       *
+ *                                                                       *
+ * Delimiters are found 64 bytes at a time: csv_scan64 returns a bitmask *
+ * of the commas and newlines in a block, and the readers pop offsets    *
+ * off of that mask, so no reader walks bytes looking for the end of its *
+ * field.  mask holds the unconsumed delimiters of the block starting at *
+ * block, and scanned is where the next block starts.                    */
+typedef struct csv_file {
+  const char *data;
+  const char *end;
+  const char *pos;
+  size_t size;
+  const char *block;
+  const char *scanned;
+  uint64_t mask;
+} csv_file_t;
+
+bool csv_open(csv_file_t *f, const char *path);
+void csv_close(csv_file_t *f);
+
+/* Chosen at startup: AVX2, SSE2 or plain C, whatever the CPU supports. *
+ * p must have 64 readable bytes; use csv_scan_tail() for the remainder. */
+extern uint64_t (*csv_scan64)(const char *p);
+uint64_t csv_scan_tail(const char *p, const char *end);
+
+/* Restricts f to [begin, end), which must start at the beginning of a *
+ * row.  Used to hand line-aligned pieces of one file to several       *
+ * threads.                                                            */
+static inline void csv_set_range(csv_file_t *f,
+                                 const char *begin, const char *end)
+{
+  f->pos = f->block = f->scanned = begin;
+  f->end = end;
+  f->mask = 0;
+}
+
+static inline bool csv_eof(const csv_file_t *f)
+{
+  return f->pos >= f->end;
+}
+
+// Returns the next delimiter at or after pos, or end if there isn't one.
+static inline const char *csv_next_delim(csv_file_t *f)
+{
+  const char *d;
+
+  while (!f->mask) {
+    if (f->scanned >= f->end) {
+      return f->end;
+    }
+    f->block = f->scanned;
+    f->mask = ((f->end - f->block >= 64) ?
+               csv_scan64(f->block)       :
+               csv_scan_tail(f->block, f->end));
+    f->scanned = f->block + 64;
+  }
+  d = f->block + __builtin_ctzll(f->mask);
+  f->mask &= f->mask - 1;
+
+  return d;
+}
+
+/* Consumes the next field, returning its extent.  A '\r' before the *
+ * newline isn't part of the field.                                  */
+static inline const char *csv_field(csv_file_t *f, const char **field_end)
+{
+  const char *start = f->pos;
+  const char *d = csv_next_delim(f);
+
+  f->pos = d < f->end ? d + 1 : f->end;
+  if (d > start && d[-1] == '\r') {
+    d--;
+  }
+  *field_end = d;
+
+  return start;
+}
+
+static inline void csv_skip_field(csv_file_t *f)
+{
+  const char *e;
+
+  csv_field(f, &e);
+}
+
+static inline void csv_skip_line(csv_file_t *f)
+{
+  const char *d;
+
+  do {
+    d = csv_next_delim(f);
+  } while (d < f->end && *d != '\n');
+  f->pos = d < f->end ? d + 1 : f->end;
+}
+
+/* Empty fields read as null_value; the loader passes INT_MAX for the *
+ * nullable columns, matching what the tables have always stored.     */
+static inline int csv_int(csv_file_t *f, int null_value)
+{
+  const char *p, *e;
+  bool negative;
+  int i;
+
+  p = csv_field(f, &e);
+  if (p == e) {
+    return null_value;
+  }
+  if ((negative = (*p == '-'))) {
+    p++;
+  }
+  for (i = 0; p < e && *p >= '0' && *p <= '9'; p++) {
+    i = i * 10 + (*p - '0');
+  }
+
+  return negative ? -i : i;
+}
+
+/* Copies the field into s, truncating to fit, and NUL terminates it. */
+static inline void csv_string(csv_file_t *f, char *s, size_t size)
+{
+  const char *p, *e;
+  size_t i;
+
+  p = csv_field(f, &e);
+  for (i = 0; p < e && i < size - 1; p++, i++) {
+    s[i] = *p;
+  }
+  s[i] = '\0';
+}
+
+/* The other direction: rows are formatted straight into a large    *
+ * buffer that goes to the file with write(2) whenever it fills, so   *
+ * exports spend their time in I/O rather than in printf.  Integers   *
+ * equal to INT_MAX are written as empty fields, as the loader reads  *
+ * them.  Every put takes the delimiter to follow the field.  ok goes *
+ * false on the first failed write, after which output is discarded. */
+# define CSV_WRITE_BUFFER (256 * 1024)
+
+typedef struct csv_writer {
+  int fd;
+  bool ok;
+  size_t len;
+  char *buf;
+} csv_writer_t;
+
+bool csv_create(csv_writer_t *w, const char *path);
+void csv_flush(csv_writer_t *w);
+// Flushes and closes w, returning false if anything failed to write.
+bool csv_finish(csv_writer_t *w);
+
+// "00" through "99", back to back.
+extern const char csv_digit_pairs[201];
+
+static inline void csv_put_int(csv_writer_t *w, int i, char delim)
+{
+  char digits[12];
+  char *p = digits + sizeof (digits);
+  unsigned u;
+
+  if (w->len + sizeof (digits) + 1 > CSV_WRITE_BUFFER) {
+    csv_flush(w);
+  }
+  if (i != INT_MAX) {
+    u = i < 0 ? -(unsigned) i : i;
+    while (u >= 100) {
+      p -= 2;
+      memcpy(p, csv_digit_pairs + (u % 100) * 2, 2);
+      u /= 100;
+    }
+    if (u >= 10) {
+      p -= 2;
+      memcpy(p, csv_digit_pairs + u * 2, 2);
+    } else {
+      *--p = '0' + u;
+    }
+    if (i < 0) {
+      *--p = '-';
+    }
+    memcpy(w->buf + w->len, p, digits + sizeof (digits) - p);
+    w->len += digits + sizeof (digits) - p;
+  }
+  w->buf[w->len++] = delim;
+}
+
+static inline void csv_put_string(csv_writer_t *w, const char *s, char delim)
+{
+  size_t n = strlen(s);
+
+  if (w->len + n + 1 > CSV_WRITE_BUFFER) {
+    csv_flush(w);
+  }
+  if (n + 1 > CSV_WRITE_BUFFER) {
+    n = CSV_WRITE_BUFFER - 1;
+  }
+  memcpy(w->buf + w->len, s, n);
+  w->len += n;
+  w->buf[w->len++] = delim;
+}
+
+#endif
@@ -0,0 +1,419 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "db_parse.h"
+#include "db_cache.h"
+
+/* Bump this whenever any of the row structs in db_parse.h change.  The *
+ * per-table row sizes catch most of those mistakes anyway, but not a   *
+ * reordering of same-sized fields.                                     */
+#define DB_CACHE_VERSION  5
+#define DB_CACHE_MAGIC    "PK327DB"
+#define DB_CACHE_DIR      "/.poke327"
+#define DB_CACHE_FILE     "/.poke327/pokedex.cache"
+#define TYPE_NAME_LEN     32
+
+/* The cache also carries indexes that db_parse() derives from the *
+ * tables, so that a warm start doesn't rebuild them, and the       *
+ * string arena that the tables' identifiers point into.  They      *
+ * follow the tables in the image.                                  */
+enum db_cache_section {
+  sec_levelup_index = num_db_tables,
+  sec_levelup_moves,
+  sec_strings,
+  num_db_cache_sections
+};
+
+typedef struct db_cache_source {
+  int64_t mtime;
+  int64_t size;
+} db_cache_source_t;
+
+/* Each section has its own checksum, so that tables can be checked *
+ * as they are loaded rather than all at once up front.              */
+typedef struct db_cache_table {
+  uint64_t offset;
+  uint32_t rows;
+  uint32_t row_size;
+  uint64_t checksum;
+} db_cache_table_t;
+
+typedef struct db_cache_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_tables;
+  uint64_t size;
+  db_cache_source_t source[num_db_tables];
+  db_cache_table_t table[num_db_cache_sections];
+} db_cache_header_t;
+
+static uint32_t table_row_size(int t)
+{
+  switch (t) {
+  case tbl_pokemon:
+    return sizeof (pokemon[0]);
+  case tbl_moves:
+    return sizeof (moves[0]);
+  case tbl_pokemon_moves:
+    return POKEMON_MOVE_ROW_SIZE;
+  case tbl_species:
+    return sizeof (species[0]);
+  case tbl_experience:
+    return sizeof (experience[0]);
+  case tbl_type_names:
+    return TYPE_NAME_LEN;
+  case tbl_pokemon_stats:
+    return sizeof (pokemon_stats[0]);
+  case tbl_stats:
+    return sizeof (stats[0]);
+  case tbl_pokemon_types:
+    return sizeof (pokemon_types[0]);
+  case sec_levelup_index:
+    return sizeof (levelup_index[0]);
+  case sec_levelup_moves:
+    return sizeof (levelup_moves[0]);
+  case sec_strings:
+    return 1;
+  }
+
+  return 0;
+}
+
+/* Tables that are plain arrays of PODs can be copied in one shot, as *
+ * can pokemon_moves, whose columns share one block.  Only meaningful  *
+ * once the tables have been allocated.                                */
+static void *table_base(int t)
+{
+  switch (t) {
+  case tbl_pokemon:
+    return pokemon;
+  case tbl_moves:
+    return moves;
+  case tbl_pokemon_moves:
+    return pokemon_moves.pokemon_id;
+  case tbl_species:
+    return species;
+  case tbl_experience:
+    return experience;
+  case tbl_pokemon_stats:
+    return pokemon_stats;
+  case tbl_stats:
+    return stats;
+  case tbl_pokemon_types:
+    return pokemon_types;
+  case sec_levelup_index:
+    return levelup_index;
+  case sec_levelup_moves:
+    return levelup_moves;
+  }
+
+  return NULL;
+}
+
+/* Word-at-a-time FNV-1a variant.  We only need to notice truncated or *
+ * scribbled-on files, not resist anybody, and byte-wise FNV over the  *
+ * 12MB moves table costs more than we want to spend at startup.       */
+static uint64_t db_cache_checksum(const char *data, size_t len)
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+  uint64_t w;
+
+  for (; len >= sizeof (w); data += sizeof (w), len -= sizeof (w)) {
+    memcpy(&w, data, sizeof (w));
+    h = (h ^ w) * 0x100000001b3ULL;
+    h ^= h >> 32;
+  }
+  for (; len; data++, len--) {
+    h = (h ^ (uint8_t) *data) * 0x100000001b3ULL;
+  }
+
+  return h;
+}
+
+static void db_cache_stat_sources(const char *csv_prefix,
+                                  db_cache_source_t *source)
+{
+  char path[4096];
+  struct stat buf;
+  int t;
+
+  for (t = 0; t < num_db_tables; t++) {
+    snprintf(path, sizeof (path), "%s%s", csv_prefix, db_table_file[t]);
+    if (stat(path, &buf)) {
+      source[t].mtime = source[t].size = -1;
+    } else {
+      source[t].mtime = ((int64_t) buf.st_mtim.tv_sec * 1000000000LL +
+                         buf.st_mtim.tv_nsec);
+      source[t].size = buf.st_size;
+    }
+  }
+}
+
+static char *db_cache_path(const char *suffix)
+{
+  const char *home;
+  char *path;
+
+  if (!(home = getenv("HOME"))) {
+    return NULL;
+  }
+  path = (char *) malloc(strlen(home) + strlen(suffix) + 1);
+  strcpy(path, home);
+  strcat(path, suffix);
+
+  return path;
+}
+
+/* Lays out the header for tables of the given sizes.  Returns the *
+ * total file size.                                                */
+static uint64_t db_cache_layout(db_cache_header_t *h,
+                                const int rows[num_db_cache_sections])
+{
+  uint64_t offset;
+  int t;
+
+  memset(h, 0, sizeof (*h));
+  memcpy(h->magic, DB_CACHE_MAGIC, sizeof (DB_CACHE_MAGIC));
+  h->version = DB_CACHE_VERSION;
+  h->num_tables = num_db_cache_sections;
+
+  for (offset = sizeof (*h), t = 0; t < num_db_cache_sections; t++) {
+    offset = (offset + 7) & ~7ULL;
+    h->table[t].offset = offset;
+    h->table[t].rows = rows[t];
+    h->table[t].row_size = table_row_size(t);
+    offset += (uint64_t) h->table[t].rows * h->table[t].row_size;
+  }
+
+  return h->size = offset;
+}
+
+// The open cache, mapped for as long as the program runs.
+static const char *mapped;
+static size_t mapped_size;
+
+static const char *db_cache_section(int t);
+
+bool db_cache_open(const char *csv_prefix)
+{
+  db_cache_header_t expect;
+  int rows[num_db_cache_sections];
+  const db_cache_header_t *h;
+  char *path;
+  struct stat buf;
+  int fd;
+  int t;
+  bool ok;
+
+  if (!(path = db_cache_path(DB_CACHE_FILE))) {
+    return false;
+  }
+  fd = open(path, O_RDONLY);
+  free(path);
+  if (fd < 0) {
+    return false;
+  }
+  if (fstat(fd, &buf) || (size_t) buf.st_size < sizeof (*h)) {
+    close(fd);
+    return false;
+  }
+  mapped = (const char *) mmap(NULL, buf.st_size, PROT_READ,
+                              MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    mapped = NULL;
+    return false;
+  }
+  mapped_size = buf.st_size;
+  h = (const db_cache_header_t *) mapped;
+
+  // The table sizes come from the cache itself; everything else about
+  // the layout has to be exactly what we would have written.
+  for (t = 0; t < num_db_cache_sections; t++) {
+    rows[t] = h->table[t].rows;
+  }
+  db_cache_layout(&expect, rows);
+  db_cache_stat_sources(csv_prefix, expect.source);
+
+  ok = (!memcmp(h->magic, expect.magic, sizeof (h->magic))       &&
+        h->version == expect.version                             &&
+        h->num_tables == expect.num_tables                       &&
+        h->size == (uint64_t) buf.st_size                        &&
+        h->size == expect.size                                   &&
+        !memcmp(h->source, expect.source, sizeof (h->source))    &&
+        rows[sec_levelup_index] == rows[tbl_species] + 1);
+  for (t = 0; ok && t < num_db_cache_sections; t++) {
+    ok = (h->table[t].offset == expect.table[t].offset &&
+          h->table[t].row_size == expect.table[t].row_size);
+  }
+
+  // Every table with identifiers needs the strings, so they're
+  // restored now rather than with any one table.
+  if (ok && (ok = db_cache_section(sec_strings))) {
+    db_strings_load(db_cache_section(sec_strings), rows[sec_strings]);
+  }
+
+  if (!ok) {
+    munmap((void *) mapped, mapped_size);
+    mapped = NULL;
+  }
+
+  return ok;
+}
+
+// Returns the section's data if its checksum is good, otherwise NULL.
+static const char *db_cache_section(int t)
+{
+  const db_cache_table_t *s = ((const db_cache_header_t *) mapped)->table + t;
+  size_t size = (size_t) s->rows * s->row_size;
+
+  if (db_cache_checksum(mapped + s->offset, size) != s->checksum) {
+    return NULL;
+  }
+
+  return mapped + s->offset;
+}
+
+// Returns the bytes read, or 0 if the index has to be rebuilt.
+static size_t db_cache_load_levelup_index()
+{
+  const db_cache_table_t *table = ((const db_cache_header_t *) mapped)->table;
+  const char *index, *moves;
+
+  if ((index = db_cache_section(sec_levelup_index)) &&
+      (moves = db_cache_section(sec_levelup_moves))) {
+    levelup_index = (int *) malloc(table[sec_levelup_index].rows *
+                                   sizeof (*levelup_index));
+    memcpy(levelup_index, index,
+           table[sec_levelup_index].rows * sizeof (*levelup_index));
+    levelup_moves = (levelup_move *) malloc(table[sec_levelup_moves].rows *
+                                            sizeof (*levelup_moves));
+    memcpy(levelup_moves, moves,
+           table[sec_levelup_moves].rows * sizeof (*levelup_moves));
+
+    return (table[sec_levelup_index].rows * sizeof (*levelup_index) +
+            table[sec_levelup_moves].rows * sizeof (*levelup_moves));
+  }
+
+  return 0;
+}
+
+size_t db_cache_load_table(db_table t)
+{
+  const db_cache_table_t *table;
+  const char *data;
+  size_t bytes;
+  uint32_t i;
+
+  if (!mapped || !(data = db_cache_section(t))) {
+    return 0;
+  }
+  table = ((const db_cache_header_t *) mapped)->table;
+  bytes = (size_t) table[t].rows * table[t].row_size;
+
+  db_alloc_table(t, table[t].rows);
+  if (table_base(t)) {
+    memcpy(table_base(t), data, (size_t) table[t].rows * table[t].row_size);
+  } else if (t == tbl_type_names) {
+    for (i = 1; i < table[t].rows; i++) {
+      types[i] = strdup(data + i * TYPE_NAME_LEN);
+    }
+  }
+  if (t == tbl_species) {
+    bytes += db_cache_load_levelup_index();
+  }
+
+  return bytes;
+}
+
+bool db_cache_write(const char *csv_prefix, const char *path)
+{
+  db_cache_header_t *h;
+  char *image;
+  char *tmp;
+  uint64_t size;
+  uint32_t i;
+  FILE *f;
+  int t;
+  bool ok;
+
+  {
+    db_cache_header_t layout;
+    int rows[num_db_cache_sections];
+
+    for (t = 0; t < num_db_tables; t++) {
+      rows[t] = db_num_rows((db_table) t);
+    }
+    rows[sec_levelup_index] = rows[tbl_species] + 1;
+    rows[sec_levelup_moves] = levelup_index[rows[tbl_species]];
+    rows[sec_strings] = db_strings_size();
+    size = db_cache_layout(&layout, rows);
+    if (!(image = (char *) calloc(1, size))) {
+      return false;
+    }
+    memcpy(image, &layout, sizeof (layout));
+  }
+  h = (db_cache_header_t *) image;
+  db_cache_stat_sources(csv_prefix, h->source);
+
+  for (t = 0; t < num_db_cache_sections; t++) {
+    if (table_base(t)) {
+      memcpy(image + h->table[t].offset, table_base(t),
+             (size_t) h->table[t].rows * h->table[t].row_size);
+    }
+  }
+  for (i = 1; i < h->table[tbl_type_names].rows; i++) {
+    strncpy(image + h->table[tbl_type_names].offset + i * TYPE_NAME_LEN,
+            types[i], TYPE_NAME_LEN - 1);
+  }
+  memcpy(image + h->table[sec_strings].offset, db_strings,
+         h->table[sec_strings].rows);
+
+  for (t = 0; t < num_db_cache_sections; t++) {
+    h->table[t].checksum =
+      db_cache_checksum(image + h->table[t].offset,
+                        (size_t) h->table[t].rows * h->table[t].row_size);
+  }
+
+  // Write to a temporary and rename it into place so that a concurrent
+  // or interrupted run never sees a half-written cache.
+  tmp = (char *) malloc(strlen(path) + strlen(".tmp") + 1);
+  strcpy(tmp, path);
+  strcat(tmp, ".tmp");
+  ok = false;
+  if ((f = fopen(tmp, "wb"))) {
+    ok = (fwrite(image, size, 1, f) == 1);
+    ok = !fclose(f) && ok && !rename(tmp, path);
+    if (!ok) {
+      unlink(tmp);
+    }
+  }
+
+  free(tmp);
+  free(image);
+
+  return ok;
+}
+
+// Failure here is not an error; we'll just parse the CSVs again next time.
+void db_cache_save(const char *csv_prefix)
+{
+  char *path;
+
+  if (!(path = db_cache_path(DB_CACHE_DIR))) {
+    return;
+  }
+  mkdir(path, 0755);
+  free(path);
+
+  path = db_cache_path(DB_CACHE_FILE);
+  db_cache_write(csv_prefix, path);
+  free(path);
+}
@@ -0,0 +1,22 @@
+#ifndef DB_CACHE_H
+# define DB_CACHE_H
+
+# include <cstddef>
+
+# include "db_parse.h"
+
+/* Binary image of the parsed pokedex, kept in ~/.poke327/pokedex.cache. *
+ * Both open and save take the CSV directory (with trailing slash) so    *
+ * that the cache can be invalidated when any source file changes.       *
+ *                                                                       *
+ * db_cache_open() maps the cache and checks that it matches the CSVs;   *
+ * tables are then copied out one at a time by db_cache_load_table(),    *
+ * which returns the bytes it read, or 0 if that table's data doesn't    *
+ * match its checksum.                                                   */
+bool db_cache_open(const char *csv_prefix);
+size_t db_cache_load_table(db_table t);
+void db_cache_save(const char *csv_prefix);
+// Writes the loaded tables to path, which needn't be the usual place.
+bool db_cache_write(const char *csv_prefix, const char *path);
+
+#endif
@@ -3,513 +3,1024 @@
 #include <cstdlib>
 #include <sys/stat.h>
 #include <climits>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
 
 #include "db_parse.h"
+#include "db_cache.h"
+#include "csv.h"
+#include "timing.h"
 
-static char *next_token(char *start, char delim)
+#define DB_MAX_CHUNKS 64
+
+pokemon_move_db pokemon_moves;
+pokemon_db *pokemon;
+char **types;
+move_db *moves;
+pokemon_species_db *species;
+experience_db *experience;
+pokemon_stats_db *pokemon_stats;
+stats_db *stats;
+pokemon_types_db *pokemon_types;
+levelup_move *levelup_moves;
+int *levelup_index;
+species_stats_db *species_stats;
+int (*growth_exp)[DB_MAX_LEVEL + 1];
+int num_growth_rates;
+bool db_types_derived;
+bool db_growth_derived;
+hot_move_db *hot_moves;
+
+const uint8_t type_efficacy[DB_NUM_TYPES][DB_NUM_TYPES] = {
+  //               - nor fig fly poi gro roc bug gho ste fir wat gra ele psy ice dra dar fai
+  /* none     */ { 2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2 },
+  /* normal   */ { 2,  2,  2,  2,  2,  2,  1,  2,  0,  1,  2,  2,  2,  2,  2,  2,  2,  2,  2 },
+  /* fighting */ { 2,  4,  2,  1,  1,  2,  4,  1,  0,  4,  2,  2,  2,  2,  1,  4,  2,  4,  1 },
+  /* flying   */ { 2,  2,  4,  2,  2,  2,  1,  4,  2,  1,  2,  2,  4,  1,  2,  2,  2,  2,  2 },
+  /* poison   */ { 2,  2,  2,  2,  1,  1,  1,  2,  1,  0,  2,  2,  4,  2,  2,  2,  2,  2,  4 },
+  /* ground   */ { 2,  2,  2,  0,  4,  2,  4,  1,  2,  4,  4,  2,  1,  4,  2,  2,  2,  2,  2 },
+  /* rock     */ { 2,  2,  1,  4,  2,  1,  2,  4,  2,  1,  4,  2,  2,  2,  2,  4,  2,  2,  2 },
+  /* bug      */ { 2,  2,  1,  1,  1,  2,  2,  2,  1,  1,  1,  2,  4,  2,  4,  2,  2,  4,  1 },
+  /* ghost    */ { 2,  0,  2,  2,  2,  2,  2,  2,  4,  2,  2,  2,  2,  2,  4,  2,  2,  1,  2 },
+  /* steel    */ { 2,  2,  2,  2,  2,  2,  4,  2,  2,  1,  1,  1,  2,  1,  2,  4,  2,  2,  4 },
+  /* fire     */ { 2,  2,  2,  2,  2,  2,  1,  4,  2,  4,  1,  1,  4,  2,  2,  4,  1,  2,  2 },
+  /* water    */ { 2,  2,  2,  2,  2,  4,  4,  2,  2,  2,  4,  1,  1,  2,  2,  2,  1,  2,  2 },
+  /* grass    */ { 2,  2,  2,  1,  1,  4,  4,  1,  2,  1,  1,  4,  1,  2,  2,  2,  1,  2,  2 },
+  /* electric */ { 2,  2,  2,  4,  2,  0,  2,  2,  2,  2,  2,  4,  1,  1,  2,  2,  1,  2,  2 },
+  /* psychic  */ { 2,  2,  4,  2,  4,  2,  2,  2,  2,  1,  2,  2,  2,  2,  1,  2,  2,  0,  2 },
+  /* ice      */ { 2,  2,  2,  4,  2,  4,  2,  2,  2,  1,  1,  1,  4,  2,  2,  1,  4,  2,  2 },
+  /* dragon   */ { 2,  2,  2,  2,  2,  2,  2,  2,  2,  1,  2,  2,  2,  2,  2,  2,  4,  2,  0 },
+  /* dark     */ { 2,  2,  1,  2,  2,  2,  2,  2,  4,  2,  2,  2,  2,  2,  4,  2,  2,  1,  1 },
+  /* fairy    */ { 2,  2,  4,  2,  1,  2,  2,  2,  2,  1,  1,  2,  2,  2,  2,  2,  4,  4,  2 },
+};
+
+static int num_rows[num_db_tables];
+bool db_loaded[num_db_tables];
+
+// Where the CSVs are, and whether the cache matches them.
+static const char *csv_prefix;
+static bool have_cache;
+
+const char *db_table_file[num_db_tables] = {
+  "pokemon.csv",
+  "moves.csv",
+  "pokemon_moves.csv",
+  "pokemon_species.csv",
+  "experience.csv",
+  "type_names.csv",
+  "pokemon_stats.csv",
+  "stats.csv",
+  "pokemon_types.csv",
+};
+
+static uint32_t csv_intern(csv_file_t *f)
+{
+  const char *p, *e;
+
+  p = csv_field(f, &e);
+
+  return db_intern(p, e - p);
+}
+
+static void parse_pokemon(csv_file_t *f, int first, int last)
 {
   int i;
-  static char *s;
 
-  if (start) {
-    s = start;
+  for (i = first; i < last; i++) {
+    pokemon[i].id = csv_int(f, 0);
+    pokemon[i].identifier = csv_intern(f);
+    pokemon[i].species_id = csv_int(f, 0);
+    pokemon[i].height = csv_int(f, 0);
+    pokemon[i].weight = csv_int(f, 0);
+    pokemon[i].base_experience = csv_int(f, 0);
+    pokemon[i].order = csv_int(f, 0);
+    pokemon[i].is_default = csv_int(f, 0);
   }
+}
 
-  start = s;
+static void parse_moves(csv_file_t *f, int first, int last)
+{
+  int i;
 
-  for (i = 0; s[i] && s[i] != delim; i++)
-    ;
-  s[i] = '\0';
-  s = s + i + 1;
+  for (i = first; i < last; i++) {
+    moves[i].id = csv_int(f, 0);
+    moves[i].identifier = csv_intern(f);
+    moves[i].generation_id = csv_int(f, INT_MAX);
+    moves[i].type_id = csv_int(f, INT_MAX);
+    moves[i].power = csv_int(f, INT_MAX);
+    moves[i].pp = csv_int(f, INT_MAX);
+    moves[i].accuracy = csv_int(f, INT_MAX);
+    moves[i].priority = csv_int(f, INT_MAX);
+    moves[i].target_id = csv_int(f, INT_MAX);
+    moves[i].damage_class_id = csv_int(f, INT_MAX);
+    moves[i].effect_id = csv_int(f, INT_MAX);
+    moves[i].effect_chance = csv_int(f, INT_MAX);
+    moves[i].contest_type_id = csv_int(f, INT_MAX);
+    moves[i].contest_effect_id = csv_int(f, INT_MAX);
+    moves[i].super_contest_effect_id = csv_int(f, INT_MAX);
+  }
+}
+
+/* Reads an int field into a narrow column.  The all-ones value is *
+ * reserved for empty fields, so anything from there up, or below   *
+ * zero, doesn't fit and clears *ok.                                 */
+template <typename T>
+static T csv_narrow(csv_file_t *f, T null_value, bool *ok)
+{
+  int i;
 
-  return start;
+  if ((i = csv_int(f, INT_MAX)) == INT_MAX) {
+    return null_value;
+  }
+  if (i < 0 || i >= null_value) {
+    *ok = false;
+    return null_value;
+  }
+
+  return (T) i;
 }
 
-/* We can't print a "null integer", so it takes an annoying amount of code *
- * to check for INT_MAX and then print "", otherwise print the integer     *
- * value.  This function converts ints to strings only if they do not have *
- * the value INT_MAX and returns the string, so no extra work needs to be  *
- * done where we print (except calling this function).                     *
- *                                                                         *
- * Needs an internal array because arguments are processed before the      *
- * function call, so if we returned the same pointer over and over again,  *
- * we'd print a bunch of whatever the final value processed was.           */
-static const char *i2s(int i)
+/* A row with a value too wide for its column is skipped: every column *
+ * is left null, which no lookup ever matches.                          */
+static void parse_pokemon_moves(csv_file_t *f, int first, int last)
 {
-  static int next = 0;
-  static char s[20][12];
+  bool ok;
+  int i;
 
-  if (next == 20) {
-    next = 0;
+  for (i = first; i < last; i++) {
+    ok = true;
+    pokemon_moves.pokemon_id[i] = csv_narrow<uint16_t>(f, DB_NULL16, &ok);
+    pokemon_moves.version_group_id[i] = csv_narrow<uint8_t>(f, DB_NULL8, &ok);
+    pokemon_moves.move_id[i] = csv_narrow<uint16_t>(f, DB_NULL16, &ok);
+    pokemon_moves.pokemon_move_method_id[i] =
+      csv_narrow<uint8_t>(f, DB_NULL8, &ok);
+    pokemon_moves.level[i] = csv_narrow<uint8_t>(f, DB_NULL8, &ok);
+    pokemon_moves.order[i] = csv_narrow<uint8_t>(f, DB_NULL8, &ok);
+    if (!ok) {
+      fprintf(stderr, "%s: row %d out of range, skipped\n",
+              db_table_file[tbl_pokemon_moves], i);
+      pokemon_moves.pokemon_id[i] = pokemon_moves.move_id[i] = DB_NULL16;
+      pokemon_moves.version_group_id[i] = DB_NULL8;
+      pokemon_moves.pokemon_move_method_id[i] = DB_NULL8;
+      pokemon_moves.level[i] = pokemon_moves.order[i] = DB_NULL8;
+    }
   }
-  
-  if (i == INT_MAX) {
-    s[next][0] = '\0';
-  } else {
-    sprintf(s[next], "%d", i);
+}
+
+static void parse_species(csv_file_t *f, int first, int last)
+{
+  int i;
+
+  for (i = first; i < last; i++) {
+    species[i].id = csv_int(f, 0);
+    species[i].identifier = csv_intern(f);
+    species[i].generation_id = csv_int(f, INT_MAX);
+    species[i].evolves_from_species_id = csv_int(f, INT_MAX);
+    species[i].evolution_chain_id = csv_int(f, INT_MAX);
+    species[i].color_id = csv_int(f, INT_MAX);
+    species[i].shape_id = csv_int(f, INT_MAX);
+    species[i].habitat_id = csv_int(f, INT_MAX);
+    species[i].gender_rate = csv_int(f, INT_MAX);
+    species[i].capture_rate = csv_int(f, INT_MAX);
+    species[i].base_happiness = csv_int(f, INT_MAX);
+    species[i].is_baby = csv_int(f, INT_MAX);
+    species[i].hatch_counter = csv_int(f, INT_MAX);
+    species[i].has_gender_differences = csv_int(f, INT_MAX);
+    species[i].growth_rate_id = csv_int(f, INT_MAX);
+    species[i].forms_switchable = csv_int(f, INT_MAX);
+    species[i].is_legendary = csv_int(f, INT_MAX);
+    species[i].is_mythical = csv_int(f, INT_MAX);
+    species[i].order = csv_int(f, INT_MAX);
+    species[i].conquest_order = csv_int(f, INT_MAX);
   }
+}
 
-  return s[next++];
+static void parse_experience(csv_file_t *f, int first, int last)
+{
+  int i;
+
+  for (i = first; i < last; i++) {
+    experience[i].growth_rate_id = csv_int(f, 0);
+    experience[i].level = csv_int(f, INT_MAX);
+    experience[i].experience = csv_int(f, INT_MAX);
+  }
 }
 
-pokemon_move_db pokemon_moves[528239];
-pokemon_db pokemon[1093];
-char *types[19];
-move_db moves[845];
-pokemon_species_db species[899];
-experience_db experience[601];
-pokemon_stats_db pokemon_stats[6553];
-stats_db stats[9];
-pokemon_types_db pokemon_types[1676];
+static void parse_type_names(csv_file_t *f, int first, int last)
+{
+  char name[32];
+  int i, j;
 
-void db_parse(bool print)
+  // Ten languages per type; the English name is the eighth line.
+  for (i = first; i < last; i++) {
+    for (j = 0; j < 7; j++) {
+      csv_skip_line(f);
+    }
+    csv_skip_field(f);
+    csv_skip_field(f);
+    csv_string(f, name, sizeof (name));
+    types[i] = strdup(name);
+    csv_skip_line(f);
+    csv_skip_line(f);
+  }
+}
+
+static void parse_pokemon_stats(csv_file_t *f, int first, int last)
 {
-  FILE *f;
-  char line[800];
   int i;
-  char *tmp;
-  struct stat buf;
-  char *prefix;
-  int prefix_len;
-  int j;
-  int count;
-  
-  i = (strlen(getenv("HOME")) +
-       strlen("/.poke327/pokedex/pokedex/data/csv/") + 1);
-  prefix = (char *) malloc(i);
-  strcpy(prefix, getenv("HOME"));
-  strcat(prefix, "/.poke327/pokedex/pokedex/data/csv/");
 
-  if (stat(prefix, &buf)) {
-    free(prefix);
-    prefix = NULL;
+  for (i = first; i < last; i++) {
+    pokemon_stats[i].pokemon_id = csv_int(f, 0);
+    pokemon_stats[i].stat_id = csv_int(f, INT_MAX);
+    pokemon_stats[i].base_stat = csv_int(f, INT_MAX);
+    pokemon_stats[i].effort = csv_int(f, INT_MAX);
   }
+}
 
-  if (!prefix && !stat("/share/cs327", &buf)) {
-    prefix = strdup("/share/cs327/pokedex/pokedex/data/csv/");
-  } else if (!prefix) {
-    // Your third location goes here, if needed.
-    // prefix is freed later, so be sure you malloc it
+static void parse_stats(csv_file_t *f, int first, int last)
+{
+  int i;
+
+  for (i = first; i < last; i++) {
+    stats[i].id = csv_int(f, 0);
+    stats[i].damage_class_id = csv_int(f, INT_MAX);
+    stats[i].identifier = csv_intern(f);
+    stats[i].is_battle_only = csv_int(f, INT_MAX);
+    stats[i].game_index = csv_int(f, INT_MAX);
   }
+}
 
-  //No error checking on file load from here on out.  Missing
-  //files are "user error".
-  prefix_len = strlen(prefix);
-
-  prefix = (char *) realloc(prefix, prefix_len + strlen("pokemon.csv") + 1);
-  strcpy(prefix + prefix_len, "pokemon.csv");
-  
-  f = fopen(prefix, "r");
-
-  //No null byte copied here, so prefix is not technically a string anymore.
-  prefix = (char *) realloc(prefix, prefix_len + 1);
-
-  fgets(line, 80, f);
-  
-  for (i = 1; i < 1093; i++) {
-    fgets(line, 80, f);
-    pokemon[i].id = atoi(next_token(line, ','));
-    strncpy(pokemon[i].identifier, next_token(NULL, ','), 30);
-    pokemon[i].species_id = atoi(next_token(NULL, ','));
-    pokemon[i].height = atoi(next_token(NULL, ','));
-    pokemon[i].weight = atoi(next_token(NULL, ','));
-    pokemon[i].base_experience = atoi(next_token(NULL, ','));
-    pokemon[i].order = atoi(next_token(NULL, ','));
-    pokemon[i].is_default = atoi(next_token(NULL, ','));
-  }  
-
-  fclose(f);
-  
-  if (print) {
-    f = fopen("pokemon.csv", "w");
-    for (i = 1; i < 1093; i++) {
-      fprintf(f, "%s,%s,%s,%s,%s,%s,%s,%s\n",
-              i2s(pokemon[i].id),
-              pokemon[i].identifier,
-              i2s(pokemon[i].species_id),
-              i2s(pokemon[i].height),
-              i2s(pokemon[i].weight),
-              i2s(pokemon[i].base_experience),
-              i2s(pokemon[i].order),
-              i2s(pokemon[i].is_default));
+static void parse_pokemon_types(csv_file_t *f, int first, int last)
+{
+  int i;
+
+  for (i = first; i < last; i++) {
+    pokemon_types[i].pokemon_id = csv_int(f, 0);
+    pokemon_types[i].type_id = csv_int(f, INT_MAX);
+    pokemon_types[i].slot = csv_int(f, INT_MAX);
+  }
+}
+
+/* Most tables are one row per line, but type_names.csv has a line *
+ * per language for each type and we only keep the English one.     */
+static const int lines_per_row[num_db_tables] = {
+  1, 1, 1, 1, 1, 10, 1, 1, 1
+};
+
+static void (*const parse_table[num_db_tables])(csv_file_t *, int, int) = {
+  parse_pokemon,
+  parse_moves,
+  parse_pokemon_moves,
+  parse_species,
+  parse_experience,
+  parse_type_names,
+  parse_pokemon_stats,
+  parse_stats,
+  parse_pokemon_types,
+};
+
+
+/* A unit of loader work: either a whole table, or one line-aligned  *
+ * chunk of pokemon_moves.csv.  f is a view into the mapped file, and *
+ * the task fills rows [first, last) of its table.                    */
+typedef struct db_task {
+  int table;
+  csv_file_t f;
+  int first, last;
+  int64_t ns;
+} db_task_t;
+
+static void db_task_parse(db_task_t *task)
+{
+  int64_t start = timing_enabled ? timing_now() : 0;
+
+  parse_table[task->table](&task->f, task->first, task->last);
+
+  if (timing_enabled) {
+    task->ns = timing_now() - start;
+  }
+}
+
+// Stores the number of lines in the task's range in last.
+static void db_task_count_rows(db_task_t *task)
+{
+  const char *p;
+  int rows;
+
+  for (rows = 0, p = task->f.pos;
+       (p = (const char *) memchr(p, '\n', task->f.end - p));
+       p++) {
+    rows++;
+  }
+  if (task->f.end > task->f.pos && task->f.end[-1] != '\n') {
+    rows++;
+  }
+  task->last = rows;
+}
+
+static unsigned db_num_threads()
+{
+  unsigned n = std::thread::hardware_concurrency();
+
+  return n ? n : 1;
+}
+
+/* Runs every task on a pool of worker threads (the calling thread  *
+ * is one of them) and returns once all of them have finished.  The *
+ * join is the only synchronization the tables need: nobody outside *
+ * the loader looks at them until db_parse() returns.               */
+static void db_run_tasks(db_task_t *task, int n, void (*run)(db_task_t *))
+{
+  std::atomic<int> next(0);
+  std::vector<std::thread> pool;
+  unsigned i;
+
+  auto worker = [&]() {
+    int t;
+
+    while ((t = next++) < n) {
+      run(task + t);
     }
-    fclose(f);
-  }
-
-
-  prefix = (char *) realloc(prefix, prefix_len + strlen("moves.csv") + 1);
-  strcpy(prefix + prefix_len, "moves.csv");
-  
-  f = fopen(prefix, "r");
-
-  //No null byte copied here, so prefix is not technically a string anymore.
-  prefix = (char *) realloc(prefix, prefix_len + 1);
-
-  fgets(line, 800, f);
-  
-  for (i = 1; i < 845; i++) {
-    fgets(line, 800, f);
-    moves[i].id = atoi((tmp = next_token(line, ',')));
-    strcpy(moves[i].identifier, (tmp = next_token(NULL, ',')));
-    tmp = next_token(NULL, ',');
-    moves[i].generation_id = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].type_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].power =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].pp =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].accuracy =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].priority =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].target_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].damage_class_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].effect_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].effect_chance =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].contest_type_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].contest_effect_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    moves[i].super_contest_effect_id = (*tmp != '\n') ? atoi(tmp) : INT_MAX;
-  }
-
-  fclose(f);
-  
-  if (print) {
-    f = fopen("moves.csv", "w");
-    for (i = 1; i < 845; i++) {
-      fprintf(f, "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n",
-              i2s(moves[i].id),
-              moves[i].identifier,
-              i2s(moves[i].generation_id),
-              i2s(moves[i].type_id),
-              i2s(moves[i].power),
-              i2s(moves[i].pp),
-              i2s(moves[i].accuracy),
-              i2s(moves[i].priority),
-              i2s(moves[i].target_id),
-              i2s(moves[i].damage_class_id),
-              i2s(moves[i].effect_id),
-              i2s(moves[i].effect_chance),
-              i2s(moves[i].contest_type_id),
-              i2s(moves[i].contest_effect_id),
-              i2s(moves[i].super_contest_effect_id));
+  };
+
+  for (i = 1; i < db_num_threads() && i < (unsigned) n; i++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (i = 0; i < pool.size(); i++) {
+    pool[i].join();
+  }
+}
+
+/* Splits the body of f into at most n pieces, each ending just after *
+ * a newline, and returns how many it made.                           */
+static int db_split_lines(const csv_file_t *f, csv_file_t *chunk, int n)
+{
+  const char *p, *e;
+  size_t size;
+  int i;
+
+  size = (f->end - f->pos) / n + 1;
+  for (i = 0, p = f->pos; i < n && p < f->end; i++, p = e) {
+    if ((size_t) (f->end - p) <= size ||
+        !(e = (const char *) memchr(p + size, '\n', f->end - p - size))) {
+      e = f->end;
+    } else {
+      e++;
     }
-    fclose(f);
-  }
-
-  prefix = (char *) realloc(prefix,
-                            prefix_len + strlen("pokemon_moves.csv") + 1);
-  strcpy(prefix + prefix_len, "pokemon_moves.csv");
-  
-  f = fopen(prefix, "r");
-
-  //No null byte copied here, so prefix is not technically a string anymore.
-  prefix = (char *) realloc(prefix, prefix_len + 1);
-
-  fgets(line, 800, f);
-  
-  for (i = 1; i < 528239; i++) {
-    fgets(line, 800, f);
-    tmp = next_token(line, ',');
-    pokemon_moves[i].pokemon_id = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    pokemon_moves[i].version_group_id = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    pokemon_moves[i].move_id = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    pokemon_moves[i].pokemon_move_method_id = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    pokemon_moves[i].level = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    pokemon_moves[i].order = (*tmp != '\n') ? atoi(tmp) : INT_MAX;
-  }
-
-  fclose(f);
+    chunk[i] = *f;
+    csv_set_range(&chunk[i], p, e);
+  }
 
-  if (print) {
-    f = fopen("pokemon_moves.csv", "w");
-    for (i = 1; i < 528239; i++) {
-      fprintf(f, "%s,%s,%s,%s,%s,%s\n",
-              i2s(pokemon_moves[i].pokemon_id),
-              i2s(pokemon_moves[i].version_group_id),
-              i2s(pokemon_moves[i].move_id),
-              i2s(pokemon_moves[i].pokemon_move_method_id),
-              i2s(pokemon_moves[i].level),
-              i2s(pokemon_moves[i].order));
+  return i;
+}
+
+int db_num_rows(db_table t)
+{
+  db_need(t);
+
+  return num_rows[t];
+}
+
+void db_alloc_table(db_table t, int rows)
+{
+  num_rows[t] = rows;
+
+  switch (t) {
+  case tbl_pokemon:
+    pokemon = (pokemon_db *) calloc(rows, sizeof (*pokemon));
+    break;
+  case tbl_moves:
+    moves = (move_db *) calloc(rows, sizeof (*moves));
+    break;
+  case tbl_pokemon_moves:
+    pokemon_moves.pokemon_id =
+      (uint16_t *) calloc(rows, POKEMON_MOVE_ROW_SIZE);
+    pokemon_moves.move_id = pokemon_moves.pokemon_id + rows;
+    pokemon_moves.version_group_id =
+      (uint8_t *) (pokemon_moves.move_id + rows);
+    pokemon_moves.pokemon_move_method_id =
+      pokemon_moves.version_group_id + rows;
+    pokemon_moves.level = pokemon_moves.pokemon_move_method_id + rows;
+    pokemon_moves.order = pokemon_moves.level + rows;
+    break;
+  case tbl_species:
+    species = (pokemon_species_db *) calloc(rows, sizeof (*species));
+    break;
+  case tbl_experience:
+    experience = (experience_db *) calloc(rows, sizeof (*experience));
+    break;
+  case tbl_type_names:
+    types = (char **) calloc(rows, sizeof (*types));
+    break;
+  case tbl_pokemon_stats:
+    pokemon_stats = (pokemon_stats_db *) calloc(rows,
+                                                sizeof (*pokemon_stats));
+    break;
+  case tbl_stats:
+    stats = (stats_db *) calloc(rows, sizeof (*stats));
+    break;
+  case tbl_pokemon_types:
+    pokemon_types = (pokemon_types_db *) calloc(rows,
+                                                sizeof (*pokemon_types));
+    break;
+  case num_db_tables:
+    break;
+  }
+}
+
+static bool operator<(const levelup_move &f, const levelup_move &s)
+{
+  return ((f.level < s.level) || ((f.level == s.level) && f.move < s.move));
+}
+
+/* Maps species ids to species rows, with 0 for ids that aren't there. *
+ * The per-pokemon tables are keyed by pokemon id, which for default    *
+ * forms is the species id; other forms don't map to any species.       */
+static int *db_species_rows(int *max_id)
+{
+  int *row_of;
+  int i;
+
+  for (*max_id = 0, i = 1; i < num_rows[tbl_species]; i++) {
+    if (species[i].id > *max_id) {
+      *max_id = species[i].id;
     }
-    fclose(f);
-  }
-
-  prefix = (char *) realloc(prefix,
-                            prefix_len + strlen("pokemon_species.csv") + 1);
-  strcpy(prefix + prefix_len, "pokemon_species.csv");
-  
-  f = fopen(prefix, "r");
-
-  //No null byte copied here, so prefix is not technically a string anymore.
-  prefix = (char *) realloc(prefix, prefix_len + 1);
-
-  fgets(line, 800, f);
-  
-  for (i = 1; i < 899; i++) {
-    fgets(line, 800, f);
-    species[i].id = atoi((tmp = next_token(line, ',')));
-    strcpy(species[i].identifier, (tmp = next_token(NULL, ',')));
-    tmp = next_token(NULL, ',');
-    species[i].generation_id = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].evolves_from_species_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].evolution_chain_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].color_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].shape_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].habitat_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].gender_rate =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].capture_rate =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].base_happiness =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].is_baby =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].hatch_counter =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].has_gender_differences =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].growth_rate_id =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].forms_switchable =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].is_legendary =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].is_mythical =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].order =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    species[i].conquest_order = (*tmp != '\n') ? atoi(tmp) : INT_MAX;
-  }
-
-  fclose(f);
+  }
+  row_of = (int *) calloc(*max_id + 1, sizeof (*row_of));
+  for (i = 1; i < num_rows[tbl_species]; i++) {
+    row_of[species[i].id] = i;
+  }
 
-  if (print) {
-    f = fopen("pokemon_species.csv", "w");
-    for (i = 1; i < 899; i++) {
-      fprintf(f,
-              "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n",
-              i2s(species[i].id),
-              species[i].identifier,
-              i2s(species[i].generation_id),
-              i2s(species[i].evolves_from_species_id),
-              i2s(species[i].evolution_chain_id),
-              i2s(species[i].color_id),
-              i2s(species[i].shape_id),
-              i2s(species[i].habitat_id),
-              i2s(species[i].gender_rate),
-              i2s(species[i].capture_rate),
-              i2s(species[i].base_happiness),
-              i2s(species[i].is_baby),
-              i2s(species[i].hatch_counter),
-              i2s(species[i].has_gender_differences),
-              i2s(species[i].growth_rate_id),
-              i2s(species[i].forms_switchable),
-              i2s(species[i].is_legendary),
-              i2s(species[i].is_mythical),
-              i2s(species[i].order),
-              i2s(species[i].conquest_order));
+  return row_of;
+}
+
+/* Buckets the level-up rows of pokemon_moves by species in one pass, *
+ * in file order, then dedups and sorts each bucket in place.  When a *
+ * move is listed at several levels, the first listing wins.          */
+static void db_index_levelup_moves()
+{
+  int *row_of, *seen;
+  int *fill;
+  int max_id, max_move;
+  int i, j, k, begin, end;
+
+  row_of = db_species_rows(&max_id);
+
+  levelup_index = (int *) calloc(num_rows[tbl_species] + 1,
+                                 sizeof (*levelup_index));
+  for (max_move = 0, j = 1; j < num_rows[tbl_pokemon_moves]; j++) {
+    if (pokemon_moves.pokemon_move_method_id[j] == 1 &&
+        pokemon_moves.pokemon_id[j] <= max_id        &&
+        (i = row_of[pokemon_moves.pokemon_id[j]])) {
+      levelup_index[i + 1]++;
+      if (pokemon_moves.move_id[j] > max_move) {
+        max_move = pokemon_moves.move_id[j];
+      }
     }
-    fclose(f);
+  }
+  for (i = 0; i < num_rows[tbl_species]; i++) {
+    levelup_index[i + 1] += levelup_index[i];
   }
 
+  levelup_moves = (levelup_move *)
+    malloc(levelup_index[num_rows[tbl_species]] * sizeof (*levelup_moves));
+  fill = (int *) malloc(num_rows[tbl_species] * sizeof (*fill));
+  memcpy(fill, levelup_index, num_rows[tbl_species] * sizeof (*fill));
+  for (j = 1; j < num_rows[tbl_pokemon_moves]; j++) {
+    if (pokemon_moves.pokemon_move_method_id[j] == 1 &&
+        pokemon_moves.pokemon_id[j] <= max_id        &&
+        (i = row_of[pokemon_moves.pokemon_id[j]])) {
+      levelup_moves[fill[i]].level = pokemon_moves.level[j];
+      levelup_moves[fill[i]].move = pokemon_moves.move_id[j];
+      fill[i]++;
+    }
+  }
+
+  // Compacting as we go; seen[move] holds the last species that had it.
+  seen = (int *) calloc(max_move + 1, sizeof (*seen));
+  for (k = 0, i = 1; i < num_rows[tbl_species]; i++) {
+    begin = levelup_index[i];
+    end = levelup_index[i + 1];
+    levelup_index[i] = k;
+    for (j = begin; j < end; j++) {
+      if (seen[levelup_moves[j].move] != i) {
+        seen[levelup_moves[j].move] = i;
+        levelup_moves[k++] = levelup_moves[j];
+      }
+    }
+    std::sort(levelup_moves + levelup_index[i], levelup_moves + k);
+  }
+  levelup_index[num_rows[tbl_species]] = k;
+
+  free(seen);
+  free(fill);
+  free(row_of);
+}
+
+/* Gathers every species' base stats out of pokemon_stats, so that *
+ * making and levelling pokemon is indexing rather than searching.  *
+ * Small enough that this is cheaper than caching it.  Types and     *
+ * growth are left until something asks for them; see below.        */
+static void db_derive_species_stats()
+{
+  int *row_of;
+  int max_id;
+  int i, j;
 
-  prefix = (char *) realloc(prefix, prefix_len + strlen("experience.csv") + 1);
-  strcpy(prefix + prefix_len, "experience.csv");
-  
-  f = fopen(prefix, "r");
+  db_need(tbl_pokemon_stats);
 
-  //No null byte copied here, so prefix is not technically a string anymore.
-  prefix = (char *) realloc(prefix, prefix_len + 1);
+  row_of = db_species_rows(&max_id);
 
-  fgets(line, 800, f);
-  
-  for (i = 1; i < 601; i++) {
-    fgets(line, 800, f);
-    experience[i].growth_rate_id = atoi((tmp = next_token(line, ',')));
-    tmp = next_token(NULL, ',');
-    experience[i].level = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    experience[i].experience =  (*tmp != '\n') ? atoi(tmp) : INT_MAX;
+  species_stats = (species_stats_db *) calloc(num_rows[tbl_species],
+                                              sizeof (*species_stats));
+  for (j = 1; j < num_rows[tbl_pokemon_stats]; j++) {
+    if (pokemon_stats[j].pokemon_id >= 0                   &&
+        pokemon_stats[j].pokemon_id <= max_id              &&
+        (i = row_of[pokemon_stats[j].pokemon_id])          &&
+        pokemon_stats[j].stat_id >= 1                      &&
+        pokemon_stats[j].stat_id <= 6                      &&
+        pokemon_stats[j].base_stat <= UINT8_MAX) {
+      species_stats[i].base_stat[pokemon_stats[j].stat_id - 1] =
+        pokemon_stats[j].base_stat;
+    }
+  }
+  // Checked against the growth rates there are in db_growth_exp().
+  for (i = 1; i < num_rows[tbl_species]; i++) {
+    if (species[i].growth_rate_id > 0 &&
+        species[i].growth_rate_id <= UINT8_MAX) {
+      species_stats[i].growth_rate_id = species[i].growth_rate_id;
+    }
   }
 
-  fclose(f);
+  free(row_of);
+}
 
-  if (print) {
-    f = fopen("experience.csv", "w");
-    for (i = 1; i < 601; i++) {
-      fprintf(f, "%s,%s,%s\n",
-              i2s(experience[i].growth_rate_id),
-              i2s(experience[i].level),
-              i2s(experience[i].experience));
+/* Species types are only wanted once a battle starts, so pokemon_types *
+ * isn't loaded until then.                                             */
+void db_derive_species_types()
+{
+  int *row_of;
+  int max_id;
+  int i, j;
+
+  db_need(tbl_pokemon_types);
+
+  row_of = db_species_rows(&max_id);
+
+  for (j = 1; j < num_rows[tbl_pokemon_types]; j++) {
+    if (pokemon_types[j].pokemon_id >= 0                   &&
+        pokemon_types[j].pokemon_id <= max_id              &&
+        (i = row_of[pokemon_types[j].pokemon_id])          &&
+        pokemon_types[j].slot >= 1                         &&
+        pokemon_types[j].slot <= 2                         &&
+        pokemon_types[j].type_id >= 0                      &&
+        pokemon_types[j].type_id < DB_NUM_TYPES) {
+      species_stats[i].type[pokemon_types[j].slot - 1] =
+        pokemon_types[j].type_id;
     }
-    fclose(f);
-  }
-
-  prefix = (char *) realloc(prefix, prefix_len + strlen("type_names.csv") + 1);
-  strcpy(prefix + prefix_len, "type_names.csv");
-  
-  f = fopen(prefix, "r");
-
-  //No null byte copied here, so prefix is not technically a string anymore.
-  prefix = (char *) realloc(prefix, prefix_len + 1);
-
-  fgets(line, 800, f);
-  
-  for (i = 1; i < 19; i++) {
-    fgets(line, 800, f); //  1
-    fgets(line, 800, f); //  3
-    fgets(line, 800, f); //  4
-    fgets(line, 800, f); //  5
-    fgets(line, 800, f); //  6
-    fgets(line, 800, f); //  7
-    fgets(line, 800, f); //  8
-    fgets(line, 800, f); //  9 - English
-    for (j = count = 0; count < 2; j++) {
-      if (line[j] == ',') {
-        count++;
+  }
+  db_types_derived = true;
+
+  free(row_of);
+}
+
+/* Lays experience out by growth rate and level, the first time a *
+ * pokemon is made or gains experience.                            */
+void db_derive_growth_exp()
+{
+  int i, j;
+
+  db_need(tbl_experience);
+
+  for (num_growth_rates = 1, j = 1; j < num_rows[tbl_experience]; j++) {
+    if (experience[j].growth_rate_id >= num_growth_rates &&
+        experience[j].growth_rate_id <= UINT8_MAX) {
+      num_growth_rates = experience[j].growth_rate_id + 1;
+    }
+  }
+  growth_exp = (int (*)[DB_MAX_LEVEL + 1]) calloc(num_growth_rates,
+                                                  sizeof (*growth_exp));
+  for (j = 2; j <= DB_MAX_LEVEL; j++) {
+    growth_exp[0][j] = 100 * (j - 1);
+  }
+  for (j = 1; j < num_rows[tbl_experience]; j++) {
+    if (experience[j].growth_rate_id > 0                 &&
+        experience[j].growth_rate_id < num_growth_rates &&
+        experience[j].level >= 1                         &&
+        experience[j].level <= DB_MAX_LEVEL) {
+      growth_exp[experience[j].growth_rate_id][experience[j].level] =
+        experience[j].experience;
+    }
+  }
+  // Levels missing from the file cost nothing past the one before.
+  for (i = 0; i < num_growth_rates; i++) {
+    for (j = 2; j <= DB_MAX_LEVEL; j++) {
+      if (growth_exp[i][j] < growth_exp[i][j - 1]) {
+        growth_exp[i][j] = growth_exp[i][j - 1];
       }
     }
-    line[strlen(line) - 1] = '\0';
-    types[i] = strdup(line + j);
-    fgets(line, 800, f); // 11
-    fgets(line, 800, f); // 12
   }
+  db_growth_derived = true;
+}
 
-  fclose(f);
+static inline uint8_t narrow8(int i)
+{
+  return (i >= 0 && i < DB_NULL8) ? i : DB_NULL8;
+}
 
-  if (print) {
-    f = fopen("type_names.csv", "w");
-    for (i = 1; i < 19; i++) {
-      fprintf(f, "%s\n", types[i]);
+static void db_derive_hot_moves()
+{
+  int i;
+
+  db_need(tbl_moves);
+
+  hot_moves = (hot_move_db *) calloc(num_rows[tbl_moves], sizeof (*hot_moves));
+  for (i = 1; i < num_rows[tbl_moves]; i++) {
+    hot_moves[i].power = narrow8(moves[i].power);
+    hot_moves[i].accuracy = narrow8(moves[i].accuracy);
+    hot_moves[i].priority = moves[i].priority;
+    hot_moves[i].type_id = ((moves[i].type_id >= 0 &&
+                             moves[i].type_id < DB_NUM_TYPES) ?
+                            moves[i].type_id : 0);
+    hot_moves[i].damage_class_id = narrow8(moves[i].damage_class_id);
+    hot_moves[i].pp = narrow8(moves[i].pp);
+  }
+}
+
+static void print_pokemon(csv_writer_t *w)
+{
+  int i;
+
+  for (i = 1; i < num_rows[tbl_pokemon]; i++) {
+    csv_put_int(w, pokemon[i].id, ',');
+    csv_put_string(w, db_string(pokemon[i].identifier), ',');
+    csv_put_int(w, pokemon[i].species_id, ',');
+    csv_put_int(w, pokemon[i].height, ',');
+    csv_put_int(w, pokemon[i].weight, ',');
+    csv_put_int(w, pokemon[i].base_experience, ',');
+    csv_put_int(w, pokemon[i].order, ',');
+    csv_put_int(w, pokemon[i].is_default, '\n');
+  }
+}
+
+static void print_moves(csv_writer_t *w)
+{
+  int i;
+
+  for (i = 1; i < num_rows[tbl_moves]; i++) {
+    csv_put_int(w, moves[i].id, ',');
+    csv_put_string(w, db_string(moves[i].identifier), ',');
+    csv_put_int(w, moves[i].generation_id, ',');
+    csv_put_int(w, moves[i].type_id, ',');
+    csv_put_int(w, moves[i].power, ',');
+    csv_put_int(w, moves[i].pp, ',');
+    csv_put_int(w, moves[i].accuracy, ',');
+    csv_put_int(w, moves[i].priority, ',');
+    csv_put_int(w, moves[i].target_id, ',');
+    csv_put_int(w, moves[i].damage_class_id, ',');
+    csv_put_int(w, moves[i].effect_id, ',');
+    csv_put_int(w, moves[i].effect_chance, ',');
+    csv_put_int(w, moves[i].contest_type_id, ',');
+    csv_put_int(w, moves[i].contest_effect_id, ',');
+    csv_put_int(w, moves[i].super_contest_effect_id, '\n');
+  }
+}
+
+// The narrow columns of pokemon_moves store their nulls as all ones.
+static inline int n16(uint16_t i)
+{
+  return i == DB_NULL16 ? INT_MAX : i;
+}
+
+static inline int n8(uint8_t i)
+{
+  return i == DB_NULL8 ? INT_MAX : i;
+}
+
+static void print_pokemon_moves(csv_writer_t *w)
+{
+  int i;
+
+  for (i = 1; i < num_rows[tbl_pokemon_moves]; i++) {
+    csv_put_int(w, n16(pokemon_moves.pokemon_id[i]), ',');
+    csv_put_int(w, n8(pokemon_moves.version_group_id[i]), ',');
+    csv_put_int(w, n16(pokemon_moves.move_id[i]), ',');
+    csv_put_int(w, n8(pokemon_moves.pokemon_move_method_id[i]), ',');
+    csv_put_int(w, n8(pokemon_moves.level[i]), ',');
+    csv_put_int(w, n8(pokemon_moves.order[i]), '\n');
+  }
+}
+
+static void print_species(csv_writer_t *w)
+{
+  int i;
+
+  for (i = 1; i < num_rows[tbl_species]; i++) {
+    csv_put_int(w, species[i].id, ',');
+    csv_put_string(w, db_string(species[i].identifier), ',');
+    csv_put_int(w, species[i].generation_id, ',');
+    csv_put_int(w, species[i].evolves_from_species_id, ',');
+    csv_put_int(w, species[i].evolution_chain_id, ',');
+    csv_put_int(w, species[i].color_id, ',');
+    csv_put_int(w, species[i].shape_id, ',');
+    csv_put_int(w, species[i].habitat_id, ',');
+    csv_put_int(w, species[i].gender_rate, ',');
+    csv_put_int(w, species[i].capture_rate, ',');
+    csv_put_int(w, species[i].base_happiness, ',');
+    csv_put_int(w, species[i].is_baby, ',');
+    csv_put_int(w, species[i].hatch_counter, ',');
+    csv_put_int(w, species[i].has_gender_differences, ',');
+    csv_put_int(w, species[i].growth_rate_id, ',');
+    csv_put_int(w, species[i].forms_switchable, ',');
+    csv_put_int(w, species[i].is_legendary, ',');
+    csv_put_int(w, species[i].is_mythical, ',');
+    csv_put_int(w, species[i].order, ',');
+    csv_put_int(w, species[i].conquest_order, '\n');
+  }
+}
+
+static void print_experience(csv_writer_t *w)
+{
+  int i;
+
+  for (i = 1; i < num_rows[tbl_experience]; i++) {
+    csv_put_int(w, experience[i].growth_rate_id, ',');
+    csv_put_int(w, experience[i].level, ',');
+    csv_put_int(w, experience[i].experience, '\n');
+  }
+}
+
+static void print_type_names(csv_writer_t *w)
+{
+  int i;
+
+  for (i = 1; i < num_rows[tbl_type_names]; i++) {
+    csv_put_string(w, types[i], '\n');
+  }
+}
+
+static void print_pokemon_stats(csv_writer_t *w)
+{
+  int i;
+
+  for (i = 1; i < num_rows[tbl_pokemon_stats]; i++) {
+    csv_put_int(w, pokemon_stats[i].pokemon_id, ',');
+    csv_put_int(w, pokemon_stats[i].stat_id, ',');
+    csv_put_int(w, pokemon_stats[i].base_stat, ',');
+    csv_put_int(w, pokemon_stats[i].effort, '\n');
+  }
+}
+
+static void print_stats(csv_writer_t *w)
+{
+  int i;
+
+  for (i = 1; i < num_rows[tbl_stats]; i++) {
+    csv_put_int(w, stats[i].id, ',');
+    csv_put_int(w, stats[i].damage_class_id, ',');
+    csv_put_string(w, db_string(stats[i].identifier), ',');
+    csv_put_int(w, stats[i].is_battle_only, ',');
+    csv_put_int(w, stats[i].game_index, '\n');
+  }
+}
+
+static void print_pokemon_types(csv_writer_t *w)
+{
+  int i;
+
+  for (i = 1; i < num_rows[tbl_pokemon_types]; i++) {
+    csv_put_int(w, pokemon_types[i].pokemon_id, ',');
+    csv_put_int(w, pokemon_types[i].type_id, ',');
+    csv_put_int(w, pokemon_types[i].slot, '\n');
+  }
+}
+
+static void (*const print_table[num_db_tables])(csv_writer_t *) = {
+  print_pokemon,
+  print_moves,
+  print_pokemon_moves,
+  print_species,
+  print_experience,
+  print_type_names,
+  print_pokemon_stats,
+  print_stats,
+  print_pokemon_types,
+};
+
+bool db_export(const char *dir, db_format format)
+{
+  char path[4096];
+  csv_writer_t w;
+  bool ok;
+  int t;
+
+  for (t = 0; t < num_db_tables; t++) {
+    db_need((db_table) t);
+  }
+
+  if (format == db_format_cache) {
+    snprintf(path, sizeof (path), "%s/pokedex.cache", dir);
+    return db_cache_write(csv_prefix, path);
+  }
+
+  for (ok = true, t = 0; t < num_db_tables; t++) {
+    snprintf(path, sizeof (path), "%s/%s", dir, db_table_file[t]);
+    if (csv_create(&w, path)) {
+      print_table[t](&w);
+      ok = csv_finish(&w) && ok;
+    } else {
+      ok = false;
     }
-    fclose(f);
   }
 
-  prefix = (char *) realloc(prefix,
-                            prefix_len + strlen("pokemon_stats.csv") + 1);
-  strcpy(prefix + prefix_len, "pokemon_stats.csv");
-  
-  f = fopen(prefix, "r");
+  return ok;
+}
 
-  //No null byte copied here, so prefix is not technically a string anymore.
-  prefix = (char *) realloc(prefix, prefix_len + 1);
+/* Parses the wanted tables straight from their CSVs.  Returns false *
+ * if any of the files were missing.                                  */
+static bool db_parse_csvs(const bool want[num_db_tables])
+{
+  csv_file_t f[num_db_tables];
+  csv_file_t chunk[DB_MAX_CHUNKS];
+  db_task_t task[num_db_tables + DB_MAX_CHUNKS];
+  int rows[num_db_tables];
+  int num_chunks;
+  int n;
+  int i;
+  int t;
+  char path[4096];
+  bool complete;
+  int64_t ns;
+  int phase;
 
-  fgets(line, 800, f);
-  
-  for (i = 1; i < 6553; i++) {
-    fgets(line, 800, f);
-    pokemon_stats[i].pokemon_id = atoi((tmp = next_token(line, ',')));
-    tmp = next_token(NULL, ',');
-    pokemon_stats[i].stat_id = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    pokemon_stats[i].base_stat =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    pokemon_stats[i].effort =  (*tmp != '\n') ? atoi(tmp) : INT_MAX;
+  //No error checking on file load from here on out.  Missing
+  //files are "user error", though we won't cache what we got.
+  for (complete = true, t = 0; t < num_db_tables; t++) {
+    if (want[t]) {
+      snprintf(path, sizeof (path), "%s%s", csv_prefix, db_table_file[t]);
+      complete = csv_open(&f[t], path) && complete;
+      csv_skip_line(&f[t]);
+    }
   }
 
-  fclose(f);
+  // pokemon_moves.csv dwarfs everything else, so it's parsed in pieces.
+  // The first pass counts lines so that every table can be allocated at
+  // its exact size, the second parses each piece at its known row offset.
+  num_chunks = (!want[tbl_pokemon_moves] ? 0 :
+                db_split_lines(&f[tbl_pokemon_moves], chunk,
+                               (db_num_threads() * 4 < DB_MAX_CHUNKS ?
+                                db_num_threads() * 4 : DB_MAX_CHUNKS)));
 
-  if (print) {
-    f = fopen("pokemon_stats.csv", "w");
-    for (i = 1; i < 6553; i++) {
-      fprintf(f, "%s,%s,%s,%s\n",
-              i2s(pokemon_stats[i].pokemon_id),
-              i2s(pokemon_stats[i].stat_id),
-              i2s(pokemon_stats[i].base_stat),
-              i2s(pokemon_stats[i].effort));
+  for (n = 0, t = 0; t < num_db_tables; t++) {
+    if (want[t] && t != tbl_pokemon_moves) {
+      task[n].table = t;
+      task[n].f = f[t];
+      n++;
     }
-    fclose(f);
-  }
-  
-  prefix = (char *) realloc(prefix, prefix_len + strlen("stats.csv") + 1);
-  strcpy(prefix + prefix_len, "stats.csv");
-  
-  f = fopen(prefix, "r");
-
-  //No null byte copied here, so prefix is not technically a string anymore.
-  prefix = (char *) realloc(prefix, prefix_len + 1);
-
-  fgets(line, 800, f);
-  
-  for (i = 1; i < 9; i++) {
-    fgets(line, 800, f);
-    stats[i].id = atoi((tmp = next_token(line, ',')));
-    tmp = next_token(NULL, ',');
-    stats[i].damage_class_id = *tmp ? atoi(tmp) : INT_MAX;
-    strcpy(stats[i].identifier, (tmp = next_token(NULL, ',')));
-    tmp = next_token(NULL, ',');
-    stats[i].is_battle_only =  *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    stats[i].game_index =  (*tmp != '\n') ? atoi(tmp) : INT_MAX;
-  }
-
-  fclose(f);
-  
-  if (print) {
-    f = fopen("stats.csv", "w");
-    for (i = 1; i < 9; i++) {
-      fprintf(f, "%s,%s,%s,%s,%s\n",
-              i2s(stats[i].id),
-              i2s(stats[i].damage_class_id),
-              stats[i].identifier,
-              i2s(stats[i].is_battle_only),
-              i2s(stats[i].game_index));
+  }
+  for (i = 0; i < num_chunks; i++) {
+    task[n + i].table = tbl_pokemon_moves;
+    task[n + i].f = chunk[i];
+  }
+
+  phase = timing_begin("count rows");
+  db_run_tasks(task, n + num_chunks, db_task_count_rows);
+  timing_end(phase);
+
+  for (t = 0; t < num_db_tables; t++) {
+    rows[t] = 1;
+  }
+  for (i = 0; i < n + num_chunks; i++) {
+    task[i].first = rows[task[i].table];
+    rows[task[i].table] += task[i].last / lines_per_row[task[i].table];
+    task[i].last = rows[task[i].table];
+  }
+
+  for (t = 0; t < num_db_tables; t++) {
+    if (want[t]) {
+      db_alloc_table((db_table) t, rows[t]);
     }
-    fclose(f);
   }
 
-  prefix = (char *) realloc(prefix,
-                            prefix_len + strlen("pokemon_types.csv") + 1);
-  strcpy(prefix + prefix_len, "pokemon_types.csv");
-  
-  f = fopen(prefix, "r");
+  phase = timing_begin("parse");
+  db_run_tasks(task, n + num_chunks, db_task_parse);
 
-  //No null byte copied here, so prefix is not technically a string anymore.
-  prefix = (char *) realloc(prefix, prefix_len + 1);
+  // Tables were parsed side by side, so their times are the sum of
+  // their tasks' times rather than anything measured here.
+  if (timing_enabled) {
+    for (t = 0; t < num_db_tables; t++) {
+      for (ns = 0, i = 0; i < n + num_chunks; i++) {
+        if (task[i].table == t) {
+          ns += task[i].ns;
+        }
+      }
+      if (want[t]) {
+        timing_record(db_table_file[t], ns, rows[t] - 1, f[t].size);
+      }
+    }
+  }
+  timing_end(phase);
 
-  fgets(line, 800, f);
-  
-  for (i = 1; i < 1676; i++) {
-    fgets(line, 800, f);
-    pokemon_types[i].pokemon_id = atoi((tmp = next_token(line, ',')));
-    tmp = next_token(NULL, ',');
-    pokemon_types[i].type_id = *tmp ? atoi(tmp) : INT_MAX;
-    tmp = next_token(NULL, ',');
-    pokemon_types[i].slot = (*tmp != '\n') ? atoi(tmp) : INT_MAX;
+  for (t = 0; t < num_db_tables; t++) {
+    if (want[t]) {
+      csv_close(&f[t]);
+      db_loaded[t] = true;
+    }
   }
 
-  fclose(f);
-  
-  if (print) {
-    f = fopen("pokemon_types.csv", "w");
-    for (i = 1; i < 1676; i++) {
-      fprintf(f, "%s,%s,%s\n",
-              i2s(pokemon_types[i].pokemon_id),
-              i2s(pokemon_types[i].type_id),
-              i2s(pokemon_types[i].slot));
+  return complete;
+}
+
+void db_load_table(db_table t)
+{
+  bool want[num_db_tables] = { false };
+  int64_t bytes;
+  int phase;
+
+  phase = timing_begin(db_table_file[t]);
+  if (have_cache && (bytes = db_cache_load_table(t))) {
+    timing_count(phase, num_rows[t] - 1, bytes);
+  } else {
+    want[t] = true;
+    db_parse_csvs(want);
+  }
+  db_loaded[t] = true;
+
+  // The level-up index comes with the species.  The cache normally has
+  // it; if not, it has to be built from the (much bigger) moves table.
+  if (t == tbl_species && !levelup_index) {
+    db_need(tbl_pokemon_moves);
+    db_index_levelup_moves();
+  }
+  timing_end(phase);
+}
+
+void db_parse(bool print)
+{
+  bool want[num_db_tables];
+  struct stat buf;
+  char *prefix;
+  bool complete;
+  int phase;
+  int i;
+  int t;
+
+  i = (strlen(getenv("HOME")) +
+       strlen("/.poke327/pokedex/pokedex/data/csv/") + 1);
+  prefix = (char *) malloc(i);
+  strcpy(prefix, getenv("HOME"));
+  strcat(prefix, "/.poke327/pokedex/pokedex/data/csv/");
+
+  if (stat(prefix, &buf)) {
+    free(prefix);
+    prefix = NULL;
+  }
+
+  if (!prefix && !stat("/share/cs327", &buf)) {
+    prefix = strdup("/share/cs327/pokedex/pokedex/data/csv/");
+  } else if (!prefix) {
+    // Your third location goes here, if needed.
+    // prefix is kept for loading tables later, so be sure you malloc it
+  }
+
+  // Tables that aren't loaded here are loaded the first time they're
+  // needed, from the cache if possible.  Without a cache, everything is
+  // parsed up front so that next time there is one.
+  csv_prefix = prefix;
+  phase = timing_begin("open cache");
+  have_cache = db_cache_open(csv_prefix);
+  timing_end(phase);
+  if (have_cache) {
+    db_need(tbl_species);
+    db_need(tbl_moves);
+  } else {
+    for (t = 0; t < num_db_tables; t++) {
+      want[t] = true;
+    }
+    complete = db_parse_csvs(want);
+    phase = timing_begin("levelup index");
+    db_index_levelup_moves();
+    timing_end(phase);
+    if (complete) {
+      phase = timing_begin("save cache");
+      db_cache_save(csv_prefix);
+      timing_end(phase);
     }
-    fclose(f);
   }
 
+  phase = timing_begin("species stats");
+  db_derive_species_stats();
+  timing_end(phase);
+  phase = timing_begin("hot moves");
+  db_derive_hot_moves();
+  timing_end(phase);
 
-  free(prefix);
+  if (print) {
+    phase = timing_begin("export");
+    db_export(".", db_format_csv);
+    timing_end(phase);
+  }
 }
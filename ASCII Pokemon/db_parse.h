@@ -1,11 +1,30 @@
 #ifndef DB_PARSE_H
 # define DB_PARSE_H
 
-#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/* Identifiers are interned in one arena rather than kept in a fixed *
+ * array in every row; rows hold their offset, and db_string() turns  *
+ * that into a pointer.  The arena never moves, so those pointers are *
+ * good for the life of the program.                                  */
+extern const char *db_strings;
+
+static inline const char *db_string(uint32_t offset)
+{
+  return db_strings + offset;
+}
+
+// Thread safe, since the tables are parsed in parallel.
+uint32_t db_intern(const char *s, size_t len);
+
+// For the binary cache: the arena is saved and restored whole.
+size_t db_strings_size();
+void db_strings_load(const char *data, size_t size);
 
 struct pokemon_db {
   int id;
-  char identifier[30];
+  uint32_t identifier;
   int species_id;
   int height;
   int weight;
@@ -16,7 +35,7 @@ struct pokemon_db {
 
 struct move_db {
   int id;
-  char identifier[50];
+  uint32_t identifier;
   int generation_id;
   int type_id;
   int power;
@@ -32,26 +51,36 @@ struct move_db {
   int super_contest_effect_id;
 };
 
+/* pokemon_moves is half a million rows, and the only thing we ever do *
+ * with it is scan for one pokemon's level-up moves, so it's stored by  *
+ * column in the narrowest types that hold the data: 8 bytes a row      *
+ * instead of 24, and a scan only pulls in the columns it tests.  All   *
+ * six columns live in one allocation, 16-bit columns first.            *
+ *                                                                      *
+ * Empty fields are stored as all ones (DB_NULL16 and DB_NULL8), the    *
+ * narrow equivalent of INT_MAX in the other tables.                    */
+#define DB_NULL16 UINT16_MAX
+#define DB_NULL8  UINT8_MAX
+
 struct pokemon_move_db {
-  int pokemon_id;
-  int version_group_id;
-  int move_id;
-  int pokemon_move_method_id;
-  int level;
-  int order;
+  uint16_t *pokemon_id;
+  uint16_t *move_id;
+  uint8_t *version_group_id;
+  uint8_t *pokemon_move_method_id;
+  uint8_t *level;
+  uint8_t *order;
 };
 
+#define POKEMON_MOVE_ROW_SIZE (2 * sizeof (uint16_t) + 4 * sizeof (uint8_t))
+
 struct levelup_move {
   int level;
   int move;
 };
 
 struct pokemon_species_db {
-  pokemon_species_db() : levelup_moves() {}
-  ~pokemon_species_db() {}
-  
   int id;
-  char identifier[30];
+  uint32_t identifier;
   int generation_id;
   int evolves_from_species_id;
   int evolution_chain_id;
@@ -70,9 +99,6 @@ struct pokemon_species_db {
   int is_mythical;
   int order;
   int conquest_order;
-
-  std::vector<levelup_move> levelup_moves;
-  int base_stat[6];
 };
 
 struct experience_db {
@@ -91,7 +117,7 @@ struct pokemon_stats_db {
 struct stats_db {
   int id;
   int damage_class_id;
-  char identifier[30];
+  uint32_t identifier;
   int is_battle_only;
   int game_index;
 };
@@ -102,16 +128,211 @@ struct pokemon_types_db {
   int slot;
 };
 
-extern pokemon_move_db pokemon_moves[528239];
-extern pokemon_db pokemon[1093];
-extern char *types[19];
-extern move_db moves[845];
-extern pokemon_species_db species[899];
-extern experience_db experience[601];
-extern pokemon_stats_db pokemon_stats[6553];
-extern stats_db stats[9];
-extern pokemon_types_db pokemon_types[1676];
+/* One entry per CSV file we load, in load order.  Used to index *
+ * anything that needs per-table bookkeeping (see db_cache.cpp).  */
+enum db_table {
+  tbl_pokemon,
+  tbl_moves,
+  tbl_pokemon_moves,
+  tbl_species,
+  tbl_experience,
+  tbl_type_names,
+  tbl_pokemon_stats,
+  tbl_stats,
+  tbl_pokemon_types,
+  num_db_tables
+};
+
+extern const char *db_table_file[num_db_tables];
+
+/* Tables are sized to the CSVs when they're loaded.  Like the files, *
+ * they're 1-indexed; row 0 is unused, and db_num_rows() counts it.   *
+ * Outside of the loaders, use the db_ accessors, which make sure the *
+ * table is loaded, rather than these directly.                       */
+extern pokemon_move_db pokemon_moves;
+extern pokemon_db *pokemon;
+extern char **types;
+extern move_db *moves;
+extern pokemon_species_db *species;
+extern experience_db *experience;
+extern pokemon_stats_db *pokemon_stats;
+extern stats_db *stats;
+extern pokemon_types_db *pokemon_types;
+
+/* Every species' level-up moves, deduplicated and sorted by level, *
+ * built from pokemon_moves at load.  The moves of species i are     *
+ * levelup_moves[levelup_index[i]] up to levelup_index[i + 1].       */
+extern levelup_move *levelup_moves;
+extern int *levelup_index;
+
+/* Also derived at load: each species' six base stats (by species row, *
+ * in stat order) and its growth rate.  No species has a base stat     *
+ * over 255.  Its types, and growth_exp, are derived the first time    *
+ * they're asked for, so that startup doesn't load pokemon_types or    *
+ * experience.  growth_exp[rate][level] is the total experience a      *
+ * pokemon of that growth rate needs to reach level, and never falls   *
+ * as level rises.  Rate 0, for species without one or with one the    *
+ * experience table doesn't have, is a flat 100 a level.  type[1] is 0 *
+ * for species with only one type.                                     */
+#define DB_MAX_LEVEL 100
+
+struct species_stats_db {
+  uint8_t base_stat[6];
+  uint8_t growth_rate_id;
+  uint8_t type[2];
+};
+
+extern species_stats_db *species_stats;
+extern int (*growth_exp)[DB_MAX_LEVEL + 1];
+extern int num_growth_rates;
+
+/* What battles need of a move, by move row, in 6 bytes rather than *
+ * move_db's 60, so that a battle's moves all sit in a cache line or *
+ * two.  Empty power, accuracy and pp are DB_NULL8; type_id is 0 for *
+ * the types off the type chart (shadow and unknown), which no       *
+ * battle sees.  db_parse() builds it, so it's read directly, with   *
+ * no accessor.                                                      */
+struct hot_move_db {
+  uint8_t power;
+  uint8_t accuracy;
+  int8_t priority;
+  uint8_t type_id;
+  uint8_t damage_class_id;
+  uint8_t pp;
+};
+
+extern hot_move_db *hot_moves;
+
+/* How well each type hits each other type, in halves: 0 is no effect, *
+ * 1 not very effective, 2 normal and 4 super effective.  Indexed by   *
+ * attacking type_id, then defending; type 0, which hot moves and       *
+ * single-typed species use for none, is hit normally and hits so.     */
+#define DB_NUM_TYPES 19
 
+extern const uint8_t type_efficacy[DB_NUM_TYPES][DB_NUM_TYPES];
+
+/* Loads what the game needs at startup: species (with its level-up *
+ * index), moves and pokemon_stats, and derives the species stats and *
+ * hot moves from them.  Every other table is loaded the first time   *
+ * it's asked for, through db_need() or the accessors below.  With    *
+ * print, also exports everything as CSV into the current directory.  */
 void db_parse(bool print);
+int db_num_rows(db_table t);
+
+/* Writes every table into dir, either as CSV files like the ones we  *
+ * load (minus the headers) or as a pokedex.cache that can be dropped *
+ * into ~/.poke327.  Returns false if anything failed to write.       */
+enum db_format {
+  db_format_csv,
+  db_format_cache
+};
+
+bool db_export(const char *dir, db_format format);
+
+/* Loading isn't thread safe; only the main thread asks for tables. */
+extern bool db_loaded[num_db_tables];
+void db_load_table(db_table t);
+
+static inline void db_need(db_table t)
+{
+  if (!db_loaded[t]) {
+    db_load_table(t);
+  }
+}
+
+static inline pokemon_db *db_pokemon()
+{
+  db_need(tbl_pokemon);
+  return pokemon;
+}
+
+static inline move_db *db_moves()
+{
+  db_need(tbl_moves);
+  return moves;
+}
+
+static inline const pokemon_move_db &db_pokemon_moves()
+{
+  db_need(tbl_pokemon_moves);
+  return pokemon_moves;
+}
+
+static inline pokemon_species_db *db_species()
+{
+  db_need(tbl_species);
+  return species;
+}
+
+static inline experience_db *db_experience()
+{
+  db_need(tbl_experience);
+  return experience;
+}
+
+static inline char **db_types()
+{
+  db_need(tbl_type_names);
+  return types;
+}
+
+static inline pokemon_stats_db *db_pokemon_stats()
+{
+  db_need(tbl_pokemon_stats);
+  return pokemon_stats;
+}
+
+static inline stats_db *db_stats()
+{
+  db_need(tbl_stats);
+  return stats;
+}
+
+static inline pokemon_types_db *db_pokemon_types()
+{
+  db_need(tbl_pokemon_types);
+  return pokemon_types;
+}
+
+// The level-up moves of species i, in level order.
+static inline const levelup_move *db_levelup_moves(int i, int *num)
+{
+  db_need(tbl_species);
+  *num = levelup_index[i + 1] - levelup_index[i];
+  return levelup_moves + levelup_index[i];
+}
+
+// Built by db_parse(), so this needs no loading.
+static inline const species_stats_db *db_species_stats(int i)
+{
+  return species_stats + i;
+}
+
+extern bool db_types_derived;
+void db_derive_species_types();
+
+// The types of species i; type[1] is 0 for single-typed species.
+static inline const uint8_t *db_species_types(int i)
+{
+  if (!db_types_derived) {
+    db_derive_species_types();
+  }
+  return species_stats[i].type;
+}
+
+extern bool db_growth_derived;
+void db_derive_growth_exp();
+
+static inline const int *db_growth_exp(int growth_rate_id)
+{
+  if (!db_growth_derived) {
+    db_derive_growth_exp();
+  }
+  return growth_exp[growth_rate_id < num_growth_rates ? growth_rate_id : 0];
+}
+
+/* Allocates one table at the given size.  Only for the loaders, *
+ * db_parse() and the binary cache.                               */
+void db_alloc_table(db_table t, int rows);
 
 #endif
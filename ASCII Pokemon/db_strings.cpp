@@ -0,0 +1,130 @@
+#include <cstring>
+#include <cstdlib>
+#include <mutex>
+#include <sys/mman.h>
+
+#include "db_parse.h"
+
+/* The whole arena is reserved up front so that it never has to move; *
+ * the kernel only backs the pages we actually write.  The pokedex    *
+ * has well under 100K of identifiers.                                *
+ *                                                                    *
+ * Lookups go through an open-addressed hash of offsets into the      *
+ * arena.  Offset 0 is the empty string, which is never hashed, and   *
+ * doubles as the empty slot marker.                                  */
+#define DB_STRINGS_MAX (16 * 1024 * 1024)
+
+static char *db_strings_reserve()
+{
+  void *p = mmap(NULL, DB_STRINGS_MAX, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+  return p == MAP_FAILED ? NULL : (char *) p;
+}
+
+static char *arena = db_strings_reserve();
+const char *db_strings = arena;
+
+static size_t arena_len = 1;
+static uint32_t *hash;
+static uint32_t hash_size;
+static uint32_t hash_used;
+static std::mutex lock;
+
+static uint32_t db_strings_hash(const char *s, size_t len)
+{
+  uint32_t h = 2166136261U;
+
+  while (len--) {
+    h = (h ^ (uint8_t) *s++) * 16777619U;
+  }
+
+  return h;
+}
+
+static void db_strings_insert(uint32_t offset, uint32_t h)
+{
+  uint32_t i;
+
+  for (i = h & (hash_size - 1); hash[i]; i = (i + 1) & (hash_size - 1))
+    ;
+  hash[i] = offset;
+  hash_used++;
+}
+
+// Keeps the hash at most half full.
+static void db_strings_grow()
+{
+  uint32_t *old = hash;
+  uint32_t old_size = hash_size;
+  uint32_t i;
+
+  hash_size = hash_size ? hash_size * 2 : 1024;
+  hash = (uint32_t *) calloc(hash_size, sizeof (*hash));
+  hash_used = 0;
+  for (i = 0; i < old_size; i++) {
+    if (old[i]) {
+      db_strings_insert(old[i], db_strings_hash(arena + old[i],
+                                                strlen(arena + old[i])));
+    }
+  }
+  free(old);
+}
+
+uint32_t db_intern(const char *s, size_t len)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  uint32_t h, i;
+
+  if (!len || !arena || arena_len + len + 1 > DB_STRINGS_MAX) {
+    return 0;
+  }
+  if ((hash_used + 1) * 2 > hash_size) {
+    db_strings_grow();
+  }
+
+  h = db_strings_hash(s, len);
+  for (i = h & (hash_size - 1); hash[i]; i = (i + 1) & (hash_size - 1)) {
+    if (!strncmp(arena + hash[i], s, len) && !arena[hash[i] + len]) {
+      return hash[i];
+    }
+  }
+
+  hash[i] = arena_len;
+  hash_used++;
+  memcpy(arena + arena_len, s, len);
+  arena[arena_len + len] = '\0';
+  arena_len += len + 1;
+
+  return hash[i];
+}
+
+size_t db_strings_size()
+{
+  return arena_len;
+}
+
+void db_strings_load(const char *data, size_t size)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  size_t i, len;
+
+  if (!arena || !size || size > DB_STRINGS_MAX) {
+    return;
+  }
+  memcpy(arena, data, size);
+  arena[0] = arena[size - 1] = '\0';
+  arena_len = size;
+
+  free(hash);
+  hash = NULL;
+  hash_size = hash_used = 0;
+  for (i = 1; i < size; i += len + 1) {
+    if ((len = strlen(arena + i))) {
+      if ((hash_used + 1) * 2 > hash_size) {
+        db_strings_grow();
+      }
+      db_strings_insert(i, db_strings_hash(arena + i, len));
+    }
+  }
+}
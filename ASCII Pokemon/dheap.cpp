@@ -0,0 +1,154 @@
+#include "dheap.h"
+
+#ifdef BENCHMARK
+
+/* Times dheap at several arities on pathfind()'s workload, the same *
+ * one heap.c's benchmark runs: the same map, starts and passes, so   *
+ * the checksums match heap_bench's and the times can be set against *
+ * heap_t's.                                                          *
+ *                                                                    *
+ *   g++ -O2 -DBENCHMARK dheap.cpp -o dheap_bench                     *
+ *   ./dheap_bench [passes]                                           */
+
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <ctime>
+
+#define BENCH_X 80
+#define BENCH_Y 21
+#define BENCH_MAX_COST 50
+
+#define bench_cell(x, y) ((y) * BENCH_X + (x))
+
+static int32_t bench_cost[BENCH_Y][BENCH_X];
+static int32_t bench_dist[BENCH_Y][BENCH_X];
+
+static void bench_map()
+{
+  int x, y, r;
+
+  for (y = 0; y < BENCH_Y; y++) {
+    for (x = 0; x < BENCH_X; x++) {
+      r = rand() % 100;
+      if (!x || !y || x == BENCH_X - 1 || y == BENCH_Y - 1 || r < 5) {
+        bench_cost[y][x] = INT_MAX;
+      } else {
+        bench_cost[y][x] = (r < 45 ? 10 : r < 75 ? 15 : r < 95 ? 20 :
+                            BENCH_MAX_COST);
+      }
+    }
+  }
+}
+
+template <unsigned D>
+static void bench_pathfind(dheap<int32_t, std::less<int32_t>, D> &h,
+                           int sy, int sx)
+{
+  static uint32_t items[BENCH_X * BENCH_Y];
+  static int32_t keys[BENCH_X * BENCH_Y];
+  int32_t d;
+  int x, y, dx, dy;
+  uint32_t c, n;
+
+  for (y = 0; y < BENCH_Y; y++) {
+    for (x = 0; x < BENCH_X; x++) {
+      bench_dist[y][x] = INT_MAX;
+    }
+  }
+  bench_dist[sy][sx] = 0;
+
+  for (n = 0, y = 1; y < BENCH_Y - 1; y++) {
+    for (x = 1; x < BENCH_X - 1; x++) {
+      if (bench_cost[y][x] != INT_MAX) {
+        items[n] = bench_cell(x, y);
+        keys[n++] = bench_dist[y][x];
+      }
+    }
+  }
+  h.build(items, keys, n);
+
+  while (!h.empty()) {
+    c = h.pop();
+    if (bench_dist[c / BENCH_X][c % BENCH_X] == INT_MAX) {
+      continue;
+    }
+    d = (bench_dist[c / BENCH_X][c % BENCH_X] +
+         bench_cost[c / BENCH_X][c % BENCH_X]);
+    for (dy = -1; dy <= 1; dy++) {
+      for (dx = -1; dx <= 1; dx++) {
+        y = c / BENCH_X + dy;
+        x = c % BENCH_X + dx;
+        if (h.contains(bench_cell(x, y)) && bench_dist[y][x] > d) {
+          bench_dist[y][x] = d;
+          h.decrease(bench_cell(x, y), d);
+        }
+      }
+    }
+  }
+}
+
+static double now()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Returns a checksum of the distances, as heap.c's bench_run() does.
+template <unsigned D>
+static long bench_run(int passes, double *t)
+{
+  dheap<int32_t, std::less<int32_t>, D> h(BENCH_X * BENCH_Y);
+  long sum;
+  int i, x, y;
+
+  srand(1);
+  *t = now();
+  for (sum = 0, i = 0; i < passes; i++) {
+    do {
+      y = 1 + rand() % (BENCH_Y - 2);
+      x = 1 + rand() % (BENCH_X - 2);
+    } while (bench_cost[y][x] == INT_MAX);
+    bench_pathfind(h, y, x);
+    for (y = 0; y < BENCH_Y; y++) {
+      for (x = 0; x < BENCH_X; x++) {
+        sum += bench_dist[y][x] == INT_MAX ? 0 : bench_dist[y][x];
+      }
+    }
+  }
+  *t = now() - *t;
+
+  return sum;
+}
+
+template <unsigned D>
+static void bench_report(int passes)
+{
+  double t;
+  long sum;
+
+  sum = bench_run<D>(passes, &t);
+  printf("%u-ary dheap  %6.1f us/pass  (checksum %ld)\n",
+         D, t * 1e6 / passes, sum);
+}
+
+int main(int argc, char *argv[])
+{
+  int passes;
+
+  passes = argc > 1 ? atoi(argv[1]) : 2000;
+
+  srand(0);
+  bench_map();
+  bench_report<2>(passes);
+  bench_report<3>(passes);
+  bench_report<4>(passes);
+  bench_report<8>(passes);
+
+  return 0;
+}
+
+#endif
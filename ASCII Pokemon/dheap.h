@@ -0,0 +1,165 @@
+#ifndef DHEAP_H
+# define DHEAP_H
+
+# include <cassert>
+# include <cstdint>
+# include <functional>
+
+/* An indexed d-ary heap for hot C++ queues.  Where heap_t holds the     *
+ * caller's pointers and compares through a function pointer that goes  *
+ * back out to the caller's data for both keys, dheap keeps each key     *
+ * inline, next to its item, and takes the comparison as a template     *
+ * parameter, so sifting compiles down to loads and compares with no     *
+ * calls at all.                                                         *
+ *                                                                       *
+ * Items are the integers 0 to items - 1 (a cell's y * MAP_X + x, say),  *
+ * and where each one sits in the heap is kept in an array indexed by    *
+ * item, which serves for decrease key and for membership both.  All of  *
+ * the memory is allocated by the constructor; clear() empties the heap  *
+ * for reuse without giving any of it back.                              */
+template <typename Key, typename Compare = std::less<Key>, unsigned D = 2>
+class dheap {
+ private:
+  struct entry {
+    Key key;
+    uint32_t item;
+  };
+
+  entry *heap;
+  uint32_t *where;
+  uint32_t items;
+  uint32_t n;
+  Compare less;
+
+  void place(uint32_t i, const entry &e)
+  {
+    heap[i] = e;
+    where[e.item] = i;
+  }
+  void sift_up(uint32_t i)
+  {
+    entry e = heap[i];
+    uint32_t p;
+
+    while (i && less(e.key, heap[p = (i - 1) / D].key)) {
+      place(i, heap[p]);
+      i = p;
+    }
+    place(i, e);
+  }
+  void sift_down(uint32_t i)
+  {
+    entry e = heap[i];
+    uint32_t c, end, min;
+
+    while ((c = i * D + 1) < n) {
+      end = (c + D < n) ? c + D : n;
+      for (min = c++; c < end; c++) {
+        if (less(heap[c].key, heap[min].key)) {
+          min = c;
+        }
+      }
+      if (!less(heap[min].key, e.key)) {
+        break;
+      }
+      place(i, heap[min]);
+      i = min;
+    }
+    place(i, e);
+  }
+
+ public:
+  static const uint32_t absent = UINT32_MAX;
+
+  dheap(uint32_t items) : heap(new entry[items]), where(new uint32_t[items]),
+                          items(items), n(0)
+  {
+    for (uint32_t i = 0; i < items; i++) {
+      where[i] = absent;
+    }
+  }
+  ~dheap()
+  {
+    delete[] heap;
+    delete[] where;
+  }
+  dheap(const dheap &) = delete;
+  dheap &operator=(const dheap &) = delete;
+
+  void clear()
+  {
+    while (n) {
+      where[heap[--n].item] = absent;
+    }
+  }
+  bool empty() const
+  {
+    return !n;
+  }
+  uint32_t size() const
+  {
+    return n;
+  }
+  bool contains(uint32_t item) const
+  {
+    return where[item] != absent;
+  }
+  const Key &key(uint32_t item) const
+  {
+    return heap[where[item]].key;
+  }
+  uint32_t top() const
+  {
+    return heap[0].item;
+  }
+  const Key &top_key() const
+  {
+    return heap[0].key;
+  }
+
+  void push(uint32_t item, const Key &key)
+  {
+    assert(item < items && !contains(item));
+
+    heap[n].key = key;
+    heap[n].item = item;
+    sift_up(n++);
+  }
+  // key must be no greater than item's key now.
+  void decrease(uint32_t item, const Key &key)
+  {
+    heap[where[item]].key = key;
+    sift_up(where[item]);
+  }
+  uint32_t pop()
+  {
+    uint32_t item = heap[0].item;
+
+    where[item] = absent;
+    if (--n) {
+      heap[0] = heap[n];
+      sift_down(0);
+    }
+
+    return item;
+  }
+  /* Fills the heap, which must be empty, with item[i] at key[i], in *
+   * O(n), like heap_build().                                         */
+  void build(const uint32_t *item, const Key *key, uint32_t count)
+  {
+    uint32_t i;
+
+    assert(!n && count <= items);
+
+    for (n = count, i = 0; i < count; i++) {
+      heap[i].key = key[i];
+      heap[i].item = item[i];
+      where[item[i]] = i;
+    }
+    for (i = n > 1 ? (n - 2) / D + 1 : 0; i--;) {
+      sift_down(i);
+    }
+  }
+};
+
+#endif
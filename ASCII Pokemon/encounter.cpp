@@ -0,0 +1,124 @@
+#include <cstdlib>
+#include <climits>
+#include <vector>
+
+#include "encounter.h"
+#include "db_parse.h"
+#include "rng.h"
+
+/* How likely each habitat's species are on each terrain, before their *
+ * rarity is taken into account.  Columns are habitat_id, with 0 for   *
+ * the species that have none, which is most of them since gen IV.     */
+#define NUM_HABITATS 10
+
+static const uint8_t habitat_weight[num_terrain_types][NUM_HABITATS] = {
+  //              none cave forest grass mount rare rough sea urban water
+  /* boulder  */ {  1,   4,    0,    0,    4,   1,    3,   0,   0,    0 },
+  /* tree     */ {  1,   0,    6,    1,    0,   1,    0,   0,   0,    1 },
+  /* path     */ {  2,   0,    0,    2,    0,   0,    1,   0,   4,    0 },
+  /* mart     */ {  1,   0,    0,    0,    0,   0,    0,   0,   6,    0 },
+  /* center   */ {  1,   0,    0,    0,    0,   0,    0,   0,   6,    0 },
+  /* grass    */ {  2,   0,    2,    6,    1,   1,    1,   0,   1,    2 },
+  /* clearing */ {  2,   0,    1,    4,    0,   0,    1,   0,   3,    1 },
+  /* mountain */ {  2,   4,    0,    0,    6,   1,    3,   0,   0,    0 },
+  /* forest   */ {  2,   1,    6,    2,    0,   1,    0,   0,   0,    1 },
+  /* exit     */ {  2,   0,    0,    2,    0,   0,    1,   0,   4,    0 },
+};
+
+// Species without a capture rate are about as common as most.
+#define DEFAULT_CAPTURE_RATE 45
+
+/* One column of an alias table: a random column's species is kept if *
+ * the coin comes in under threshold, and traded for alias if not.    */
+typedef struct encounter_entry {
+  uint32_t threshold;
+  uint16_t species;
+  uint16_t alias;
+} encounter_entry_t;
+
+typedef struct encounter_table {
+  encounter_entry_t *entry;
+  int n;
+} encounter_table_t;
+
+static encounter_table_t table[num_terrain_types];
+
+static int species_weight(const pokemon_species_db *s, int terrain)
+{
+  int habitat, rate;
+
+  if (s->is_legendary == 1 || s->is_mythical == 1) {
+    return 0;
+  }
+  habitat = (s->habitat_id > 0 && s->habitat_id < NUM_HABITATS ?
+             s->habitat_id : 0);
+  rate = (s->capture_rate > 0 && s->capture_rate <= UINT8_MAX ?
+          s->capture_rate : DEFAULT_CAPTURE_RATE);
+
+  return habitat_weight[terrain][habitat] * rate;
+}
+
+/* Vose's method: columns that are under their share are topped up by *
+ * ones that are over it, until every column holds exactly 1/n.       */
+static void build_table(encounter_table_t *t, int terrain)
+{
+  const pokemon_species_db *species = db_species();
+  int num_species = db_num_rows(tbl_species);
+  std::vector<double> p;
+  std::vector<int> small, large;
+  double total;
+  int i, s, l, w;
+
+  t->entry = (encounter_entry_t *) malloc(num_species * sizeof (*t->entry));
+  for (total = 0, t->n = 0, i = 1; i < num_species; i++) {
+    if ((w = species_weight(species + i, terrain))) {
+      t->entry[t->n].species = t->entry[t->n].alias = i;
+      t->entry[t->n].threshold = UINT32_MAX;
+      p.push_back(w);
+      total += w;
+      t->n++;
+    }
+  }
+
+  for (i = 0; i < t->n; i++) {
+    p[i] *= t->n / total;
+    (p[i] < 1.0 ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    s = small.back();
+    small.pop_back();
+    l = large.back();
+    t->entry[s].threshold = p[s] * 4294967296.0;
+    t->entry[s].alias = t->entry[l].species;
+    p[l] -= 1.0 - p[s];
+    if (p[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // Whatever's left is full, give or take rounding, and keeps its own.
+}
+
+void encounter_init()
+{
+  int t;
+
+  for (t = 0; t < num_terrain_types; t++) {
+    build_table(&table[t], t);
+  }
+}
+
+int encounter_species(terrain_type_t t)
+{
+  const encounter_entry_t *e;
+  uint64_t r = rng_next(&rng[rng_pokemon]);
+
+  // Nothing lives here; anything will do.
+  if (!table[t].n) {
+    return 1 + rng_below(r >> 32, db_num_rows(tbl_species) - 1);
+  }
+
+  e = &table[t].entry[rng_below(r >> 32, table[t].n)];
+
+  return (uint32_t) r < e->threshold ? e->species : e->alias;
+}
@@ -0,0 +1,18 @@
+#ifndef ENCOUNTER_H
+# define ENCOUNTER_H
+
+# include "poke327.h"
+
+/* Which species turn up where.  Each terrain has an alias table over *
+ * the species that can be found on it, weighted by how well their    *
+ * habitat suits the terrain and by how common they are (their        *
+ * capture rate), so a draw is one random number and two reads.       *
+ * Legendary and mythical species are never wild.                     *
+ *                                                                    *
+ * encounter_init() builds the tables, once the pokedex is loaded.    */
+void encounter_init();
+
+// Returns a species row, for pokemon::pokemon(level, species).
+int encounter_species(terrain_type_t t);
+
+#endif
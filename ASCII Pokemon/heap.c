@@ -6,13 +6,37 @@
 #include "heap.h"
 
 struct heap_node {
-  heap_node_t *next;
-  heap_node_t *prev;
-  heap_node_t *parent;
-  heap_node_t *child;
+  union {
+    struct {
+      heap_node_t *next;
+      heap_node_t *prev;
+      union {
+        struct {
+          heap_node_t *parent;
+          heap_node_t *child;
+          uint32_t degree;
+          uint32_t mark;
+        };
+        int32_t key;      /* Bucket queues: what it's filed under */
+      };
+    };
+    uint32_t index;       /* d-ary heaps: where its entry is */
+  };
   void *datum;
-  uint32_t degree;
-  uint32_t mark;
+};
+
+/* d-ary heaps keep the datum next to its node pointer in the array, *
+ * so that sifting compares without touching the nodes at all.       */
+struct heap_entry {
+  void *datum;
+  heap_node_t *node;
+};
+
+#define DARY_MIN_CAPACITY 64
+
+struct heap_chunk {
+  struct heap_chunk *next;
+  heap_node_t node[];
 };
 
 #define swap(a, b) ({    \
@@ -99,6 +123,374 @@ void heap_init(heap_t *h,
   h->size = 0;
   h->compare = compare;
   h->datum_delete = datum_delete;
+  h->arity = 0;
+  h->capacity = 0;
+  h->entry = NULL;
+  h->arena = NULL;
+  h->key = NULL;
+  h->span = 0;
+  h->cur = 0;
+  h->filed = 0;
+  h->bucket = NULL;
+}
+
+void heap_init_dary(heap_t *h, uint32_t arity,
+                    int32_t (*compare)(const void *key, const void *with),
+                    void (*datum_delete)(void *))
+{
+  assert(arity >= 2);
+
+  heap_init(h, compare, datum_delete);
+  h->arity = arity;
+}
+
+void heap_init_buckets(heap_t *h, uint32_t max_step,
+                       int32_t (*key)(const void *v),
+                       void (*datum_delete)(void *))
+{
+  heap_init(h, NULL, datum_delete);
+  h->key = key;
+  h->span = max_step + 1;
+}
+
+void heap_arena_init(heap_arena_t *a, uint32_t chunk_size)
+{
+  assert(chunk_size);
+
+  memset(a, 0, sizeof (*a));
+  a->chunk_size = chunk_size;
+}
+
+void heap_arena_delete(heap_arena_t *a)
+{
+  struct heap_chunk *c;
+
+  while ((c = a->chunk)) {
+    a->chunk = c->next;
+    free(c);
+  }
+  free(a->spare);
+  memset(a, 0, sizeof (*a));
+}
+
+/* Takes the arena's spare array, if it has one, and tells its size. */
+static void *heap_arena_take(heap_arena_t *a, size_t *size)
+{
+  void *p;
+
+  p = a->spare;
+  *size = a->spare_size;
+  a->spare = NULL;
+  a->spare_size = 0;
+
+  return p;
+}
+
+/* Hands an array back to h's arena, which keeps the bigger of it and *
+ * its spare.  Without an arena, it's freed.                          */
+static void heap_arena_give(heap_t *h, void *p, size_t size)
+{
+  heap_arena_t *a;
+
+  if ((a = h->arena) && size > a->spare_size) {
+    free(a->spare);
+    a->spare = p;
+    a->spare_size = size;
+  } else {
+    free(p);
+  }
+}
+
+void heap_set_arena(heap_t *h, heap_arena_t *a)
+{
+  size_t size;
+
+  assert(!h->size);
+
+  h->arena = a;
+  if (h->arity && a->spare) {
+    free(h->entry);
+    h->entry = heap_arena_take(a, &size);
+    h->capacity = size / sizeof (*h->entry);
+  }
+}
+
+static heap_node_t *heap_node_alloc(heap_t *h)
+{
+  heap_arena_t *a;
+  struct heap_chunk *c;
+  heap_node_t *n;
+  uint32_t i;
+
+  if (!(a = h->arena)) {
+    assert((n = malloc(sizeof (*n))));
+    return n;
+  }
+
+  if (!a->free) {
+    assert((c = malloc(sizeof (*c) + a->chunk_size * sizeof (c->node[0]))));
+    c->next = a->chunk;
+    a->chunk = c;
+    for (i = a->chunk_size; i; i--) {
+      c->node[i - 1].next = a->free;
+      a->free = &c->node[i - 1];
+    }
+    a->stats.chunks++;
+  }
+
+  n = a->free;
+  a->free = n->next;
+  a->stats.allocs++;
+  a->stats.live++;
+
+  return n;
+}
+
+/* Rethreads an arena with nothing live so that nodes come off it in *
+ * address order, as they did from fresh chunks.                      */
+static void heap_arena_reset(heap_arena_t *a)
+{
+  struct heap_chunk *c;
+  uint32_t i;
+
+  for (a->free = NULL, c = a->chunk; c; c = c->next) {
+    for (i = a->chunk_size; i; i--) {
+      c->node[i - 1].next = a->free;
+      a->free = &c->node[i - 1];
+    }
+  }
+}
+
+static void heap_node_free(heap_t *h, heap_node_t *n)
+{
+  heap_arena_t *a;
+
+  if (!(a = h->arena)) {
+    free(n);
+    return;
+  }
+
+  n->next = a->free;
+  a->free = n;
+  a->stats.frees++;
+  a->stats.live--;
+}
+
+static void dary_place(heap_t *h, uint32_t i, heap_entry_t e)
+{
+  h->entry[i] = e;
+  e.node->index = i;
+}
+
+static void dary_sift_up(heap_t *h, uint32_t i)
+{
+  heap_entry_t e;
+  uint32_t p;
+
+  e = h->entry[i];
+  while (i) {
+    p = (i - 1) / h->arity;
+    if (h->compare(e.datum, h->entry[p].datum) >= 0) {
+      break;
+    }
+    dary_place(h, i, h->entry[p]);
+    i = p;
+  }
+  dary_place(h, i, e);
+}
+
+static void dary_sift_down(heap_t *h, uint32_t i)
+{
+  heap_entry_t e;
+  uint32_t c, end, min;
+
+  e = h->entry[i];
+  while ((c = i * h->arity + 1) < h->size) {
+    end = (c + h->arity < h->size) ? c + h->arity : h->size;
+    for (min = c++; c < end; c++) {
+      if (h->compare(h->entry[c].datum, h->entry[min].datum) < 0) {
+        min = c;
+      }
+    }
+    if (h->compare(h->entry[min].datum, e.datum) >= 0) {
+      break;
+    }
+    dary_place(h, i, h->entry[min]);
+    i = min;
+  }
+  dary_place(h, i, e);
+}
+
+/* Makes room for n more entries. */
+static void dary_reserve(heap_t *h, uint32_t n)
+{
+  if (h->size + n > h->capacity) {
+    if (!h->capacity) {
+      h->capacity = DARY_MIN_CAPACITY;
+    }
+    while (h->size + n > h->capacity) {
+      h->capacity *= 2;
+    }
+    assert((h->entry = realloc(h->entry,
+                               h->capacity * sizeof (*h->entry))));
+    if (h->arena) {
+      h->arena->stats.arrays++;
+    }
+  }
+}
+
+static heap_node_t *dary_insert(heap_t *h, void *v)
+{
+  heap_node_t *n;
+
+  dary_reserve(h, 1);
+  n = heap_node_alloc(h);
+  n->datum = v;
+  h->entry[h->size].datum = v;
+  h->entry[h->size].node = n;
+  dary_sift_up(h, h->size++);
+
+  return n;
+}
+
+static void *dary_remove_min(heap_t *h)
+{
+  void *v;
+
+  if (!h->size) {
+    return NULL;
+  }
+
+  v = h->entry[0].datum;
+  heap_node_free(h, h->entry[0].node);
+  if (--h->size) {
+    h->entry[0] = h->entry[h->size];
+    dary_sift_down(h, 0);
+  }
+
+  return v;
+}
+
+static void dary_delete(heap_t *h)
+{
+  uint32_t i;
+
+  for (i = 0; i < h->size; i++) {
+    if (h->datum_delete) {
+      h->datum_delete(h->entry[i].datum);
+    }
+    heap_node_free(h, h->entry[i].node);
+  }
+
+  heap_arena_give(h, h->entry, h->capacity * sizeof (*h->entry));
+}
+
+/* Buckets are circular lists, like the Fibonacci heap's, so that equal *
+ * keys come out first in, first out.  bucket[span] holds the          *
+ * unreached, with key INT32_MAX, and cur is the lowest key in any     *
+ * bucket, once the buckets have been searched for it.                 */
+static void bucket_reserve(heap_t *h)
+{
+  size_t size;
+
+  if (h->bucket) {
+    return;
+  }
+
+  size = 0;
+  if (h->arena) {
+    h->bucket = heap_arena_take(h->arena, &size);
+  }
+  if (size < (h->span + 1) * sizeof (*h->bucket)) {
+    free(h->bucket);
+    size = (h->span + 1) * sizeof (*h->bucket);
+    assert((h->bucket = malloc(size)));
+    if (h->arena) {
+      h->arena->stats.arrays++;
+    }
+  }
+  h->capacity = size / sizeof (*h->bucket);
+  memset(h->bucket, 0, (h->span + 1) * sizeof (*h->bucket));
+}
+
+static heap_node_t **bucket_of(heap_t *h, int32_t key)
+{
+  return &h->bucket[key == INT32_MAX ? h->span : (uint32_t) key % h->span];
+}
+
+static void bucket_file(heap_t *h, heap_node_t *n)
+{
+  heap_node_t **b;
+
+  n->key = h->key(n->datum);
+  if (n->key != INT32_MAX) {
+    if (!h->filed) {
+      h->cur = n->key;
+    }
+    assert(n->key >= h->cur && (uint32_t) (n->key - h->cur) < h->span);
+    h->filed++;
+  }
+
+  if (*(b = bucket_of(h, n->key))) {
+    insert_heap_node_in_list(n, *b);
+  } else {
+    *b = n->next = n->prev = n;
+  }
+}
+
+static void bucket_unfile(heap_t *h, heap_node_t *n)
+{
+  heap_node_t **b;
+
+  b = bucket_of(h, n->key);
+  if (n->next == n) {
+    *b = NULL;
+  } else {
+    remove_heap_node_from_list(n);
+    if (*b == n) {
+      *b = n->next;
+    }
+  }
+  if (n->key != INT32_MAX) {
+    h->filed--;
+  }
+}
+
+static heap_node_t *bucket_min(heap_t *h)
+{
+  if (!h->size) {
+    return NULL;
+  }
+  if (!h->filed) {
+    return h->bucket[h->span];
+  }
+
+  while (!h->bucket[(uint32_t) h->cur % h->span]) {
+    h->cur++;
+  }
+
+  return h->bucket[(uint32_t) h->cur % h->span];
+}
+
+static void bucket_delete(heap_t *h)
+{
+  heap_node_t *n;
+  uint32_t i;
+
+  if (!h->bucket) {
+    return;
+  }
+
+  for (i = 0; i <= h->span; i++) {
+    while ((n = h->bucket[i])) {
+      bucket_unfile(h, n);
+      if (h->datum_delete) {
+        h->datum_delete(n->datum);
+      }
+      heap_node_free(h, n);
+    }
+  }
+  heap_arena_give(h, h->bucket, h->capacity * sizeof (*h->bucket));
 }
 
 void heap_node_delete(heap_t *h, heap_node_t *hn)
@@ -114,27 +506,41 @@ void heap_node_delete(heap_t *h, heap_node_t *hn)
     if (h->datum_delete) {
       h->datum_delete(hn->datum);
     }
-    free(hn);
+    heap_node_free(h, hn);
     hn = next;
   }
 }
 
 void heap_delete(heap_t *h)
 {
-  if (h->min) {
+  if (h->span) {
+    bucket_delete(h);
+  } else if (h->arity) {
+    dary_delete(h);
+  } else if (h->min) {
     heap_node_delete(h, h->min);
   }
-  h->min = NULL;
-  h->size = 0;
-  h->compare = NULL;
-  h->datum_delete = NULL;
+  heap_init(h, NULL, NULL);
 }
 
 heap_node_t *heap_insert(heap_t *h, void *v)
 {
   heap_node_t *n;
 
-  assert((n = calloc(1, sizeof (*n))));
+  if (h->span) {
+    bucket_reserve(h);
+    n = heap_node_alloc(h);
+    n->datum = v;
+    bucket_file(h, n);
+    h->size++;
+    return n;
+  }
+  if (h->arity) {
+    return dary_insert(h, v);
+  }
+
+  n = heap_node_alloc(h);
+  memset(n, 0, sizeof (*n));
   n->datum = v;
 
   if (h->min) {
@@ -150,8 +556,80 @@ heap_node_t *heap_insert(heap_t *h, void *v)
   return n;
 }
 
+void heap_build(heap_t *h, void *items[], uint32_t n, heap_node_t *nodes[])
+{
+  heap_node_t *hn;
+  uint32_t i;
+
+  assert(!h->size);
+
+  if (!n) {
+    return;
+  }
+  if (h->arena && !h->arena->stats.live) {
+    heap_arena_reset(h->arena);
+  }
+
+  if (h->span) {
+    bucket_reserve(h);
+    for (i = 0; i < n; i++) {
+      hn = heap_node_alloc(h);
+      hn->datum = items[i];
+      bucket_file(h, hn);
+      if (nodes) {
+        nodes[i] = hn;
+      }
+    }
+    h->size = n;
+  } else if (h->arity) {
+    dary_reserve(h, n);
+    for (i = 0; i < n; i++) {
+      hn = heap_node_alloc(h);
+      hn->datum = items[i];
+      hn->index = i;
+      h->entry[i].datum = items[i];
+      h->entry[i].node = hn;
+      if (nodes) {
+        nodes[i] = hn;
+      }
+    }
+    h->size = n;
+    /* Only the parents need sifting, from the last one up. */
+    for (i = n > 1 ? (n - 2) / h->arity + 1 : 0; i--;) {
+      dary_sift_down(h, i);
+    }
+  } else {
+    for (i = 0; i < n; i++) {
+      hn = heap_node_alloc(h);
+      memset(hn, 0, sizeof (*hn));
+      hn->datum = items[i];
+      if (h->min) {
+        insert_heap_node_in_list(hn, h->min);
+        if (h->compare(items[i], h->min->datum) < 0) {
+          h->min = hn;
+        }
+      } else {
+        h->min = hn->next = hn->prev = hn;
+      }
+      if (nodes) {
+        nodes[i] = hn;
+      }
+    }
+    h->size = n;
+  }
+}
+
 void *heap_peek_min(heap_t *h)
 {
+  heap_node_t *n;
+
+  if (h->span) {
+    return (n = bucket_min(h)) ? n->datum : NULL;
+  }
+  if (h->arity) {
+    return h->size ? h->entry[0].datum : NULL;
+  }
+
   return h->min ? h->min->datum : NULL;
 }
 
@@ -215,12 +693,26 @@ void *heap_remove_min(heap_t *h)
   void *v;
   heap_node_t *n;
 
+  if (h->span) {
+    if (!(n = bucket_min(h))) {
+      return NULL;
+    }
+    bucket_unfile(h, n);
+    v = n->datum;
+    heap_node_free(h, n);
+    h->size--;
+    return v;
+  }
+  if (h->arity) {
+    return dary_remove_min(h);
+  }
+
   v = NULL;
 
   if (h->min) {
     v = h->min->datum;
     if (h->size == 1) {
-      free(h->min);
+      heap_node_free(h, h->min);
       h->min = NULL;
     } else {
       if ((n = h->min->child)) {
@@ -234,7 +726,7 @@ void *heap_remove_min(heap_t *h)
       n = h->min;
       remove_heap_node_from_list(n);
       h->min = n->next;
-      free(n);
+      heap_node_free(h, n);
 
       heap_consolidate(h);
     }
@@ -247,15 +739,32 @@ void *heap_remove_min(heap_t *h)
 
 int heap_combine(heap_t *h, heap_t *h1, heap_t *h2)
 {
+  uint32_t i;
+
   if (h1->compare != h2->compare ||
-      h1->datum_delete != h2->datum_delete) {
+      h1->datum_delete != h2->datum_delete ||
+      h1->arity != h2->arity                ||
+      h1->arena != h2->arena                ||
+      h1->span || h2->span) {
     return 1;
   }
 
-  h->compare = h1->compare;
-  h->datum_delete = h1->datum_delete;
+  heap_init(h, h1->compare, h1->datum_delete);
+  h->arity = h1->arity;
+  h->arena = h1->arena;
 
-  if (!h1->min) {
+  if (h->arity) {
+    /* h2's nodes move into h1's array, so handles stay good. */
+    h->size = h1->size;
+    h->capacity = h1->capacity;
+    h->entry = h1->entry;
+    for (i = 0; i < h2->size; i++) {
+      dary_reserve(h, 1);
+      h->entry[h->size] = h2->entry[i];
+      dary_sift_up(h, h->size++);
+    }
+    heap_arena_give(h, h2->entry, h2->capacity * sizeof (*h2->entry));
+  } else if (!h1->min) {
     h->min = h2->min;
     h->size = h2->size;
   } else if (!h2->min) {
@@ -304,7 +813,7 @@ static void heap_cascading_cut(heap_t *h, heap_node_t *n)
 
 int heap_decrease_key(heap_t *h, heap_node_t *n, void *v)
 {
-  if (h->compare(n->datum, v) <= 0) {
+  if (h->span ? h->key(v) >= n->key : h->compare(n->datum, v) <= 0) {
     return 1;
   }
 
@@ -312,6 +821,9 @@ int heap_decrease_key(heap_t *h, heap_node_t *n, void *v)
     h->datum_delete(n->datum);
   }
   n->datum = v;
+  if (h->arity) {
+    h->entry[n->index].datum = v;
+  }
 
   return heap_decrease_key_no_replace(h, n);
 }
@@ -325,6 +837,16 @@ int heap_decrease_key_no_replace(heap_t *h, heap_node_t *n)
 
   heap_node_t *p;
 
+  if (h->span) {
+    bucket_unfile(h, n);
+    bucket_file(h, n);
+    return 0;
+  }
+  if (h->arity) {
+    dary_sift_up(h, n->index);
+    return 0;
+  }
+
   p = n->parent;
 
   if (p && (h->compare(n->datum, p->datum) < 0)) {
@@ -403,3 +925,199 @@ int main(int argc, char *argv[])
 }
 
 #endif
+
+#ifdef BENCHMARK
+
+/* Times the heaps on pathfind()'s workload: a hiker distance map     *
+ * over an 80x21 map, with every open cell built in up front and      *
+ * decrease key through a comparator that reads the distance array.   *
+ * Terrain is drawn in about the proportions new_map() makes.         *
+ *                                                                    *
+ *   gcc -O2 -DBENCHMARK heap.c -o heap_bench                         *
+ *   ./heap_bench [passes]                                            */
+
+#include <limits.h>
+#include <time.h>
+
+#define BENCH_X 80
+#define BENCH_Y 21
+#define BENCH_MAX_COST 50
+
+typedef struct bench_path {
+  heap_node_t *hn;
+  uint8_t pos[2];
+} bench_path_t;
+
+static int32_t bench_cost[BENCH_Y][BENCH_X];
+static int32_t bench_dist[BENCH_Y][BENCH_X];
+static bench_path_t bench_p[BENCH_Y][BENCH_X];
+
+static int32_t bench_key(const void *v)
+{
+  return bench_dist[((bench_path_t *) v)->pos[0]][((bench_path_t *) v)->pos[1]];
+}
+
+static int32_t bench_cmp(const void *key, const void *with)
+{
+  return (bench_dist[((bench_path_t *) key)->pos[0]]
+                    [((bench_path_t *) key)->pos[1]] -
+          bench_dist[((bench_path_t *) with)->pos[0]]
+                    [((bench_path_t *) with)->pos[1]]);
+}
+
+static void bench_map(void)
+{
+  int x, y, r;
+
+  for (y = 0; y < BENCH_Y; y++) {
+    for (x = 0; x < BENCH_X; x++) {
+      r = rand() % 100;
+      if (!x || !y || x == BENCH_X - 1 || y == BENCH_Y - 1 || r < 5) {
+        bench_cost[y][x] = INT_MAX;
+      } else {
+        bench_cost[y][x] = (r < 45 ? 10 : r < 75 ? 15 : r < 95 ? 20 :
+                            BENCH_MAX_COST);
+      }
+      bench_p[y][x].pos[0] = y;
+      bench_p[y][x].pos[1] = x;
+    }
+  }
+}
+
+static void bench_pathfind(heap_t *h, int sy, int sx)
+{
+  static void *items[BENCH_X * BENCH_Y];
+  static heap_node_t *nodes[BENCH_X * BENCH_Y];
+  bench_path_t *c;
+  int32_t d;
+  int x, y, dx, dy;
+  uint32_t i, n;
+
+  for (y = 0; y < BENCH_Y; y++) {
+    for (x = 0; x < BENCH_X; x++) {
+      bench_dist[y][x] = INT_MAX;
+    }
+  }
+  bench_dist[sy][sx] = 0;
+
+  for (n = 0, y = 1; y < BENCH_Y - 1; y++) {
+    for (x = 1; x < BENCH_X - 1; x++) {
+      if (bench_cost[y][x] != INT_MAX) {
+        items[n++] = &bench_p[y][x];
+      } else {
+        bench_p[y][x].hn = NULL;
+      }
+    }
+  }
+  heap_build(h, items, n, nodes);
+  for (i = 0; i < n; i++) {
+    ((bench_path_t *) items[i])->hn = nodes[i];
+  }
+
+  while ((c = heap_remove_min(h))) {
+    c->hn = NULL;
+    if (bench_dist[c->pos[0]][c->pos[1]] == INT_MAX) {
+      continue;
+    }
+    d = bench_dist[c->pos[0]][c->pos[1]] + bench_cost[c->pos[0]][c->pos[1]];
+    for (dy = -1; dy <= 1; dy++) {
+      for (dx = -1; dx <= 1; dx++) {
+        y = c->pos[0] + dy;
+        x = c->pos[1] + dx;
+        if (bench_p[y][x].hn && bench_dist[y][x] > d) {
+          bench_dist[y][x] = d;
+          heap_decrease_key_no_replace(h, bench_p[y][x].hn);
+        }
+      }
+    }
+  }
+  heap_delete(h);
+}
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Runs passes distance maps from random starts with heaps of arity *
+ * (0 for Fibonacci, 1 for a bucket queue), from arena if it isn't   *
+ * NULL; returns a checksum of the distances.                        */
+static long bench_run(uint32_t arity, heap_arena_t *arena, int passes,
+                      double *t)
+{
+  heap_t h;
+  long sum;
+  int i, x, y;
+
+  srand(1);
+  *t = now();
+  for (sum = 0, i = 0; i < passes; i++) {
+    do {
+      y = 1 + rand() % (BENCH_Y - 2);
+      x = 1 + rand() % (BENCH_X - 2);
+    } while (bench_cost[y][x] == INT_MAX);
+    if (arity == 1) {
+      heap_init_buckets(&h, BENCH_MAX_COST, bench_key, NULL);
+    } else if (arity) {
+      heap_init_dary(&h, arity, bench_cmp, NULL);
+    } else {
+      heap_init(&h, bench_cmp, NULL);
+    }
+    if (arena) {
+      heap_set_arena(&h, arena);
+    }
+    bench_pathfind(&h, y, x);
+    for (y = 0; y < BENCH_Y; y++) {
+      for (x = 0; x < BENCH_X; x++) {
+        sum += bench_dist[y][x] == INT_MAX ? 0 : bench_dist[y][x];
+      }
+    }
+  }
+  *t = now() - *t;
+
+  return sum;
+}
+
+int main(int argc, char *argv[])
+{
+  static const uint32_t arity[] = { 0, 2, 4, 8, 1 };
+  heap_arena_t arena;
+  int passes;
+  double t;
+  long sum;
+  uint32_t i, j;
+
+  passes = argc > 1 ? atoi(argv[1]) : 2000;
+
+  srand(0);
+  bench_map();
+  for (j = 0; j < 2; j++) {
+    for (i = 0; i < sizeof (arity) / sizeof (arity[0]); i++) {
+      heap_arena_init(&arena, BENCH_X * BENCH_Y);
+      sum = bench_run(arity[i], j ? &arena : NULL, passes, &t);
+      if (arity[i] == 1) {
+        printf("buckets   ");
+      } else if (arity[i]) {
+        printf("%u-ary heap", arity[i]);
+      } else {
+        printf("fibonacci ");
+      }
+      printf("%s  %6.1f us/pass  (checksum %ld)", j ? " + arena" : "        ",
+             t * 1e6 / passes, sum);
+      if (j) {
+        printf("  %lu allocator calls",
+               (unsigned long) (arena.stats.chunks + arena.stats.arrays));
+      }
+      printf("\n");
+      heap_arena_delete(&arena);
+    }
+  }
+
+  return 0;
+}
+
+#endif
@@ -5,23 +5,100 @@
 extern "C" {
 # endif
 
+# include <stddef.h>
 # include <stdint.h>
 
 struct heap_node;
 typedef struct heap_node heap_node_t;
+struct heap_entry;
+typedef struct heap_entry heap_entry_t;
+struct heap_chunk;
 
+/* Where a heap's nodes come from.  Without an arena, each is malloc()ed *
+ * and freed on its own.  A heap given one (heap_set_arena()) takes its  *
+ * nodes off the arena's free list instead, carving out a chunk at a     *
+ * time when that runs dry, and puts them back as they're removed.  The  *
+ * array that a d-ary heap or a bucket queue keeps is handed back to the *
+ * arena by heap_delete(), for the next heap to reuse whatever its kind. *
+ * Arenas never shrink, so once one has grown to fit, heaps that use it  *
+ * make no allocator calls at all.  Any number of heaps can share one.   *
+ *                                                                       *
+ * chunks and arrays count the allocator calls an arena has made.        */
+typedef struct heap_arena_stats {
+  uint64_t allocs;
+  uint64_t frees;
+  uint64_t live;
+  uint64_t chunks;
+  uint64_t arrays;
+} heap_arena_stats_t;
+
+typedef struct heap_arena {
+  heap_node_t *free;
+  struct heap_chunk *chunk;
+  uint32_t chunk_size;
+  size_t spare_size;      /* in bytes */
+  void *spare;
+  heap_arena_stats_t stats;
+} heap_arena_t;
+
+void heap_arena_init(heap_arena_t *a, uint32_t chunk_size);
+/* Frees everything; every heap using a must have been deleted. */
+void heap_arena_delete(heap_arena_t *a);
+
+/* A heap is a Fibonacci heap (heap_init()), an array-backed d-ary heap *
+ * (heap_init_dary()) or a bucket queue (heap_init_buckets()); every    *
+ * other call works on all three, and the nodes heap_insert() returns   *
+ * are good for decrease key in all of them.                            *
+ *                                                                      *
+ * The Fibonacci heap has the better bounds, but the d-ary heap keeps   *
+ * the queue in one array, d children to a run, so for the few         *
+ * thousand nodes of a map's worth of pathfinding it's faster.          *
+ *                                                                      *
+ * A bucket queue (Dial's) makes no comparisons at all.  It takes each  *
+ * datum's key, a non-negative integer, from key(), and files it in one *
+ * of max_step + 1 buckets, so every key it's given must be within      *
+ * max_step above the last one removed, as in Dijkstra's algorithm with *
+ * edges of at most max_step; INT32_MAX is also allowed, for "not yet   *
+ * reached", and comes out last.  Anything else fails an assertion, so  *
+ * costs that aren't small integers belong in one of the heaps.  Equal  *
+ * keys come out in the order they went in.  Bucket queues can't be     *
+ * combined.                                                            */
 typedef struct heap {
   heap_node_t *min;
   uint32_t size;
   int32_t (*compare)(const void *key, const void *with);
   void (*datum_delete)(void *);
+  uint32_t arity;         /* 0 unless a d-ary heap */
+  uint32_t capacity;
+  heap_entry_t *entry;
+  heap_arena_t *arena;
+  int32_t (*key)(const void *v);
+  uint32_t span;          /* 0 unless a bucket queue */
+  int32_t cur;
+  uint32_t filed;         /* keys in buckets, rather than unreached */
+  heap_node_t **bucket;
 } heap_t;
 
 void heap_init(heap_t *h,
                int32_t (*compare)(const void *key, const void *with),
                void (*datum_delete)(void *));
+void heap_init_dary(heap_t *h, uint32_t arity,
+                    int32_t (*compare)(const void *key, const void *with),
+                    void (*datum_delete)(void *));
+void heap_init_buckets(heap_t *h, uint32_t max_step,
+                       int32_t (*key)(const void *v),
+                       void (*datum_delete)(void *));
+/* Only on an empty heap, straight after initializing it. */
+void heap_set_arena(heap_t *h, heap_arena_t *a);
 void heap_delete(heap_t *h);
 heap_node_t *heap_insert(heap_t *h, void *v);
+/* Fills h, which must be empty, with the n items in O(n): Floyd's     *
+ * method for d-ary heaps, one root list for Fibonacci heaps, straight *
+ * into the buckets for bucket queues.  If nodes isn't NULL, nodes[i]  *
+ * gets items[i]'s node, as heap_insert() would have returned it.      *
+ * When h's arena has nothing live, the nodes are laid out             *
+ * contiguously, in the order of items.                                */
+void heap_build(heap_t *h, void *items[], uint32_t n, heap_node_t *nodes[]);
 void *heap_peek_min(heap_t *h);
 void *heap_remove_min(heap_t *h);
 int heap_combine(heap_t *h, heap_t *h1, heap_t *h2);
@@ -235,11 +235,12 @@ uint32_t io_teleport_pc(pair_t dest)
   /* Just for fun. And debugging.  Mostly debugging. */
 
   do {
-    dest[dim_x] = rand_range(1, MAP_X - 2);
-    dest[dim_y] = rand_range(1, MAP_Y - 2);
+    dest[dim_x] = rand_range(&rng[rng_world], 1, MAP_X - 2);
+    dest[dim_y] = rand_range(&rng[rng_world], 1, MAP_Y - 2);
   } while (world.cur_map->cmap[dest[dim_y]][dest[dim_x]]                  ||
            move_cost[char_pc][world.cur_map->map[dest[dim_y]]
                                                 [dest[dim_x]]] == INT_MAX ||
+           world.rival_dist[dest[dim_y]][dest[dim_x]] == INT_MAX          ||
            world.rival_dist[dest[dim_y]][dest[dim_x]] < 0);
 
   return 0;
@@ -570,11 +571,10 @@ void io_deposit_clean_up(int p)
   }
   for(int i = p; i < party_size; i++)
   {
-    world.pc.party[i] = (pokemon *) malloc(sizeof(*world.pc.party[i]));
-    memcpy(world.pc.party[i], world.pc.party[i + 1], sizeof(pokemon));
+    world.pc.party[i] = new pokemon(*world.pc.party[i + 1]);
     world.pc.current_party_hp[i] = world.pc.current_party_hp[i + 1];
     world.pc.current_party_hp[i + 1] = -1;
-    free(world.pc.party[i + 1]);
+    delete world.pc.party[i + 1];
     world.pc.party[i + 1] = NULL;
   }
 }
@@ -607,10 +607,9 @@ void io_deposit()
           io_top_clear();
           mvprintw(0, 0, "Depositing %s%s%s...", world.pc.party[0]->is_shiny() ? "*" : "", world.pc.party[0]->get_species(), world.pc.party[0]->is_shiny() ? "*" : "");
           getch();
-          world.pc.box[first_empty_box_slot] = (pokemon *) malloc(sizeof(*world.pc.box[first_empty_box_slot]));
-          memcpy(world.pc.box[first_empty_box_slot], world.pc.party[0], sizeof(pokemon));
+          world.pc.box[first_empty_box_slot] = new pokemon(*world.pc.party[0]);
           first_empty_box_slot++;
-          free(world.pc.party[0]);
+          delete world.pc.party[0];
           world.pc.party[0] = NULL;
           world.pc.current_party_hp[0] = -1;
           io_deposit_clean_up(0);
@@ -631,10 +630,9 @@ void io_deposit()
           io_top_clear();
           mvprintw(0, 0, "Depositing %s%s%s...", world.pc.party[1]->is_shiny() ? "*" : "", world.pc.party[1]->get_species(), world.pc.party[1]->is_shiny() ? "*" : "");
           getch();
-          world.pc.box[first_empty_box_slot] = (pokemon *) malloc(sizeof(*world.pc.box[first_empty_box_slot]));
-          memcpy(world.pc.box[first_empty_box_slot], world.pc.party[1], sizeof(pokemon));
+          world.pc.box[first_empty_box_slot] = new pokemon(*world.pc.party[1]);
           first_empty_box_slot++;
-          free(world.pc.party[1]);
+          delete world.pc.party[1];
           world.pc.party[1] = NULL;
           world.pc.current_party_hp[1] = -1;
           io_deposit_clean_up(1);
@@ -655,10 +653,9 @@ void io_deposit()
           io_top_clear();
           mvprintw(0, 0, "Depositing %s%s%s...", world.pc.party[2]->is_shiny() ? "*" : "", world.pc.party[2]->get_species(), world.pc.party[2]->is_shiny() ? "*" : "");
           getch();
-          world.pc.box[first_empty_box_slot] = (pokemon *) malloc(sizeof(*world.pc.box[first_empty_box_slot]));
-          memcpy(world.pc.box[first_empty_box_slot], world.pc.party[2], sizeof(pokemon));
+          world.pc.box[first_empty_box_slot] = new pokemon(*world.pc.party[2]);
           first_empty_box_slot++;
-          free(world.pc.party[2]);
+          delete world.pc.party[2];
           world.pc.party[2] = NULL;
           world.pc.current_party_hp[2] = -1;
           io_deposit_clean_up(2);
@@ -679,10 +676,9 @@ void io_deposit()
           io_top_clear();
           mvprintw(0, 0, "Depositing %s%s%s...", world.pc.party[3]->is_shiny() ? "*" : "", world.pc.party[3]->get_species(), world.pc.party[3]->is_shiny() ? "*" : "");
           getch();
-          world.pc.box[first_empty_box_slot] = (pokemon *) malloc(sizeof(*world.pc.box[first_empty_box_slot]));
-          memcpy(world.pc.box[first_empty_box_slot], world.pc.party[3], sizeof(pokemon));
+          world.pc.box[first_empty_box_slot] = new pokemon(*world.pc.party[3]);
           first_empty_box_slot++;
-          free(world.pc.party[3]);
+          delete world.pc.party[3];
           world.pc.party[3] = NULL;
           world.pc.current_party_hp[3] = -1;
           io_deposit_clean_up(3);
@@ -703,10 +699,9 @@ void io_deposit()
           io_top_clear();
           mvprintw(0, 0, "Depositing %s%s%s...", world.pc.party[4]->is_shiny() ? "*" : "", world.pc.party[4]->get_species(), world.pc.party[4]->is_shiny() ? "*" : "");
           getch();
-          world.pc.box[first_empty_box_slot] = (pokemon *) malloc(sizeof(*world.pc.box[first_empty_box_slot]));
-          memcpy(world.pc.box[first_empty_box_slot], world.pc.party[4], sizeof(pokemon));
+          world.pc.box[first_empty_box_slot] = new pokemon(*world.pc.party[4]);
           first_empty_box_slot++;
-          free(world.pc.party[4]);
+          delete world.pc.party[4];
           world.pc.party[4] = NULL;
           world.pc.current_party_hp[4] = -1;
           io_deposit_clean_up(4);
@@ -727,10 +722,9 @@ void io_deposit()
           io_top_clear();
           mvprintw(0, 0, "Depositing %s%s%s...", world.pc.party[5]->is_shiny() ? "*" : "", world.pc.party[5]->get_species(), world.pc.party[5]->is_shiny() ? "*" : "");
           getch();
-          world.pc.box[first_empty_box_slot] = (pokemon *) malloc(sizeof(*world.pc.box[first_empty_box_slot]));
-          memcpy(world.pc.box[first_empty_box_slot], world.pc.party[5], sizeof(pokemon));
+          world.pc.box[first_empty_box_slot] = new pokemon(*world.pc.party[5]);
           first_empty_box_slot++;
-          free(world.pc.party[5]);
+          delete world.pc.party[5];
           world.pc.party[5] = NULL;
           world.pc.current_party_hp[5] = -1;
           io_top_clear();
@@ -749,9 +743,8 @@ void io_withdraw_clean_up(int index)
 {
   while(world.pc.box[index + 1] != NULL && index < 99)
   {
-    world.pc.box[index] = (pokemon *) malloc(sizeof(*world.pc.box[index]));
-    memcpy(world.pc.box[index], world.pc.box[index + 1], sizeof(pokemon));
-    free(world.pc.box[index + 1]);
+    world.pc.box[index] = new pokemon(*world.pc.box[index + 1]);
+    delete world.pc.box[index + 1];
     world.pc.box[index + 1] = NULL;
     index++;
   } 
@@ -817,10 +810,9 @@ void io_withdraw()
           io_top_clear();
           mvprintw(0, 0, "Withdrawing %s%s%s...", world.pc.box[page * 5]->is_shiny() ? "*" : "", world.pc.box[page * 5]->get_species(), world.pc.box[page * 5]->is_shiny() ? "*" : "");
           getch();
-          world.pc.party[first_open_party_slot] = (pokemon *) malloc(sizeof(*world.pc.party[first_open_party_slot]));
-          memcpy(world.pc.party[first_open_party_slot], world.pc.box[page * 5], sizeof(pokemon));
+          world.pc.party[first_open_party_slot] = new pokemon(*world.pc.box[page * 5]);
           world.pc.current_party_hp[first_open_party_slot] = world.pc.party[first_open_party_slot]->get_hp();
-          free(world.pc.box[page * 5]);
+          delete world.pc.box[page * 5];
           world.pc.box[page * 5] = NULL;
           io_withdraw_clean_up(page * 5);
           io_top_clear();
@@ -841,10 +833,9 @@ void io_withdraw()
           io_top_clear();
           mvprintw(0, 0, "Withdrawing %s%s%s...", world.pc.box[(page * 5) + 1]->is_shiny() ? "*" : "", world.pc.box[(page * 5) + 1]->get_species(), world.pc.box[(page * 5) + 1]->is_shiny() ? "*" : "");
           getch();
-          world.pc.party[first_open_party_slot] = (pokemon *) malloc(sizeof(*world.pc.party[first_open_party_slot]));
-          memcpy(world.pc.party[first_open_party_slot], world.pc.box[(page * 5) + 1], sizeof(pokemon));
+          world.pc.party[first_open_party_slot] = new pokemon(*world.pc.box[(page * 5) + 1]);
           world.pc.current_party_hp[first_open_party_slot] = world.pc.party[first_open_party_slot]->get_hp();
-          free(world.pc.box[(page * 5) + 1]);
+          delete world.pc.box[(page * 5) + 1];
           world.pc.box[(page * 5) + 1] = NULL;
           io_withdraw_clean_up((page * 5) + 1);
           io_top_clear();
@@ -865,10 +856,9 @@ void io_withdraw()
           io_top_clear();
           mvprintw(0, 0, "Withdrawing %s%s%s...", world.pc.box[(page * 5) + 2]->is_shiny() ? "*" : "", world.pc.box[(page * 5) + 2]->get_species(), world.pc.box[(page * 5) + 2]->is_shiny() ? "*" : "");
           getch();
-          world.pc.party[first_open_party_slot] = (pokemon *) malloc(sizeof(*world.pc.party[first_open_party_slot]));
-          memcpy(world.pc.party[first_open_party_slot], world.pc.box[(page * 5) + 2], sizeof(pokemon));
+          world.pc.party[first_open_party_slot] = new pokemon(*world.pc.box[(page * 5) + 2]);
           world.pc.current_party_hp[first_open_party_slot] = world.pc.party[first_open_party_slot]->get_hp();
-          free(world.pc.box[(page * 5) + 2]);
+          delete world.pc.box[(page * 5) + 2];
           world.pc.box[(page * 5) + 2] = NULL;
           io_withdraw_clean_up((page * 5) + 2);
           io_top_clear();
@@ -889,10 +879,9 @@ void io_withdraw()
           io_top_clear();
           mvprintw(0, 0, "Withdrawing %s%s%s...", world.pc.box[(page * 5) + 3]->is_shiny() ? "*" : "", world.pc.box[(page * 5) + 3]->get_species(), world.pc.box[(page * 5) + 3]->is_shiny() ? "*" : "");
           getch();
-          world.pc.party[first_open_party_slot] = (pokemon *) malloc(sizeof(*world.pc.party[first_open_party_slot]));
-          memcpy(world.pc.party[first_open_party_slot], world.pc.box[(page * 5) + 3], sizeof(pokemon));
+          world.pc.party[first_open_party_slot] = new pokemon(*world.pc.box[(page * 5) + 3]);
           world.pc.current_party_hp[first_open_party_slot] = world.pc.party[first_open_party_slot]->get_hp();
-          free(world.pc.box[(page * 5) + 3]);
+          delete world.pc.box[(page * 5) + 3];
           world.pc.box[(page * 5) + 3] = NULL;
           io_withdraw_clean_up((page * 5) + 3);
           io_top_clear();
@@ -913,10 +902,9 @@ void io_withdraw()
           io_top_clear();
           mvprintw(0, 0, "Withdrawing %s%s%s...", world.pc.box[(page * 5) + 4]->is_shiny() ? "*" : "", world.pc.box[(page * 5) + 4]->get_species(), world.pc.box[(page * 5) + 4]->is_shiny() ? "*" : "");
           getch();
-          world.pc.party[first_open_party_slot] = (pokemon *) malloc(sizeof(*world.pc.party[first_open_party_slot]));
-          memcpy(world.pc.party[first_open_party_slot], world.pc.box[(page * 5) + 4], sizeof(pokemon));
+          world.pc.party[first_open_party_slot] = new pokemon(*world.pc.box[(page * 5) + 4]);
           world.pc.current_party_hp[first_open_party_slot] = world.pc.party[first_open_party_slot]->get_hp();
-          free(world.pc.box[(page * 5) + 4]);
+          delete world.pc.box[(page * 5) + 4];
           world.pc.box[(page * 5) + 4] = NULL;
           io_withdraw_clean_up((page * 5) + 4);
           io_top_clear();
@@ -1213,7 +1201,7 @@ bool io_catch_pokemon(pokemon *p)
 {
   int first_empty_box_slot = 0;
   io_top_clear();
-  if(rand() % 100 < 75)
+  if(rng_percent(&rng[rng_battle], 75))
   {
     if(world.pc.party[5] != NULL)
     {
@@ -1221,8 +1209,7 @@ bool io_catch_pokemon(pokemon *p)
       {
         first_empty_box_slot++;
       }
-      world.pc.box[first_empty_box_slot] = (pokemon*) malloc(sizeof(*world.pc.box[first_empty_box_slot]));
-      memcpy(world.pc.box[first_empty_box_slot], p, sizeof(pokemon));
+      world.pc.box[first_empty_box_slot] = new pokemon(*p);
       io_top_clear();
       mvprintw(0, 0, "%s%s%s caught!", world.pc.box[first_empty_box_slot]->is_shiny() ? "*": "", world.pc.box[first_empty_box_slot]->get_species(), world.pc.box[first_empty_box_slot]->is_shiny() ? "*" : "");
       getch();
@@ -1235,8 +1222,7 @@ bool io_catch_pokemon(pokemon *p)
     {
       int index = 0;
       while(world.pc.party[index] != NULL && index != 5) index++;
-      world.pc.party[index] = (pokemon *) malloc(sizeof(*world.pc.party[index]));
-      memcpy(world.pc.party[index], p, sizeof(pokemon));
+      world.pc.party[index] = new pokemon(*p);
       //world.pc.current_party_hp[index] = 0; //FOR THE PURPOSE OF TESTING REVIVE AND POTIONS
       world.pc.current_party_hp[index] = world.pc.party[index]->get_hp();
       io_top_clear();
@@ -1371,6 +1357,24 @@ void io_choose_starter()
   io_queue_message("%s%s%s chosen as your starter!", world.pc.party[0]->is_shiny() ? "*" : "", world.pc.party[0]->get_species(), world.pc.party[0]->is_shiny() ? "*" : "");
 }
 
+/* The damage formula, scaled for same-type attacks and type matchups *
+ * from the tables.  Moves without power, status moves, do no damage. */
+static int io_move_damage(pokemon *attacker, int move, pokemon *defender,
+                          double critical)
+{
+  int level = attacker->get_level();
+  int power = attacker->get_move_power(move);
+
+  if (power == INT_MAX) {
+    return 0;
+  }
+
+  return (((((2 * level / 5) + 2) * power *
+            ((double) attacker->get_atk() / defender->get_def()) / 50) + 2) *
+          critical * 3 * level / 3 *
+          attacker->get_move_multiplier(move, defender));
+}
+
 void io_opponent_attack(int active_pokemon, pokemon *p)
 {
   int npc_damage = 0;
@@ -1384,15 +1388,15 @@ void io_opponent_attack(int active_pokemon, pokemon *p)
       total_npc_moves++;
     }
   }
-  npc_move_index = rand() % total_npc_moves;
-  if((rand() % 100) <= 20) critical = 1.5;
+  npc_move_index = rng_range(&rng[rng_battle], total_npc_moves);
+  if(rng_range(&rng[rng_battle], 100) <= 20) critical = 1.5;
   else critical = 1;
   io_top_clear();
   mvprintw(0, 0, "The wild %s%s%s used %s!", p->is_shiny() ? "*" : "", p->get_species(),p->is_shiny() ? "*" : "", p->get_move(npc_move_index));
   getch();
-  if((rand() % 100) < p->get_move_accuracy(npc_move_index))
+  if(rng_range(&rng[rng_battle], 100) < p->get_move_accuracy(npc_move_index))
   {
-    npc_damage = ((((2 * p->get_level() / 5) + 2) * p->get_move_power(npc_move_index) * (p->get_atk() / p->get_def()) /50) + 2) * critical * 3 * p->get_level() / 3; // no stab, no type
+    npc_damage = io_move_damage(p, npc_move_index, world.pc.party[active_pokemon], critical);
     if(critical == 1.5)
     {
       io_top_clear();
@@ -1427,7 +1431,7 @@ int io_damage(int active_pokemon, int move_index, pokemon *p, int current_wild_h
       total_npc_moves++;
     }
   }
-  npc_move_index = rand() % total_npc_moves;
+  npc_move_index = rng_range(&rng[rng_battle], total_npc_moves);
   if(world.pc.party[active_pokemon]->get_move_priority(move_index) > p->get_move_priority(npc_move_index)) first = 0;
   else if (world.pc.party[active_pokemon]->get_move_priority(move_index) < p->get_move_priority(npc_move_index)) first = 1;
   else
@@ -1438,14 +1442,14 @@ int io_damage(int active_pokemon, int move_index, pokemon *p, int current_wild_h
   
   if(first == 0)
   {
-    if((rand() % 100) <= 20) critical = 1.5;
+    if(rng_range(&rng[rng_battle], 100) <= 20) critical = 1.5;
     else critical = 1;
     io_top_clear();
     mvprintw(0, 0, "%s%s%s used %s!", world.pc.party[active_pokemon]->is_shiny() ? "*" : "", world.pc.party[active_pokemon]->get_species(), world.pc.party[active_pokemon]->is_shiny() ? "*" : "", world.pc.party[active_pokemon]->get_move(move_index));
     getch();
-    if((rand() % 100) < world.pc.party[active_pokemon]->get_move_accuracy(move_index))
+    if(rng_range(&rng[rng_battle], 100) < world.pc.party[active_pokemon]->get_move_accuracy(move_index))
     {
-      pc_damage = ((((2 * world.pc.party[active_pokemon]->get_level() / 5) + 2) * world.pc.party[active_pokemon]->get_move_power(move_index) * (world.pc.party[active_pokemon]->get_atk() / world.pc.party[active_pokemon]->get_def()) /50) + 2) * critical * 3 * world.pc.party[active_pokemon]->get_level() / 3; // no stab, no type
+      pc_damage = io_move_damage(world.pc.party[active_pokemon], move_index, p, critical);
       if(critical == 1.5)
       {
         io_top_clear();
@@ -1462,14 +1466,14 @@ int io_damage(int active_pokemon, int move_index, pokemon *p, int current_wild_h
     }
     if(pc_damage < current_wild_hp)
     {
-      if((rand() % 100) <= 20) critical = 1.5;
+      if(rng_range(&rng[rng_battle], 100) <= 20) critical = 1.5;
       else critical = 1;
       io_top_clear();
       mvprintw(0, 0, "The wild %s%s%s used %s!", p->is_shiny() ? "*" : "", p->get_species(),p->is_shiny() ? "*" : "", p->get_move(npc_move_index));
       getch();
-      if((rand() % 100) < p->get_move_accuracy(move_index))
+      if(rng_range(&rng[rng_battle], 100) < p->get_move_accuracy(npc_move_index))
       {
-        npc_damage = ((((2 * p->get_level() / 5) + 2) * p->get_move_power(move_index) * (p->get_atk() / p->get_def()) /50) + 2) * critical * 3 * p->get_level() / 3; // no stab, no type
+        npc_damage = io_move_damage(p, npc_move_index, world.pc.party[active_pokemon], critical);
         if(critical == 1.5)
         {
           io_top_clear();
@@ -1490,14 +1494,14 @@ int io_damage(int active_pokemon, int move_index, pokemon *p, int current_wild_h
   }
   else
   {
-    if((rand() % 100) <= 20) critical = 1.5;
+    if(rng_range(&rng[rng_battle], 100) <= 20) critical = 1.5;
     else critical = 1;
     io_top_clear();
     mvprintw(0, 0, "The wild %s%s%s used %s!", p->is_shiny() ? "*" : "", p->get_species(),p->is_shiny() ? "*" : "", p->get_move(npc_move_index));
     getch();
-    if((rand() % 100) < p->get_move_accuracy(move_index))
+    if(rng_range(&rng[rng_battle], 100) < p->get_move_accuracy(npc_move_index))
     {
-      npc_damage = ((((2 * p->get_level() / 5) + 2) * p->get_move_power(move_index) * (p->get_atk() / p->get_def()) /50) + 2) * critical * 3 * p->get_level() / 3; // no stab, no type
+      npc_damage = io_move_damage(p, npc_move_index, world.pc.party[active_pokemon], critical);
       if(critical == 1.5)
       {
         io_top_clear();
@@ -1516,14 +1520,14 @@ int io_damage(int active_pokemon, int move_index, pokemon *p, int current_wild_h
     if(world.pc.current_party_hp[active_pokemon] < 0) world.pc.current_party_hp[active_pokemon] = 0;
     if(world.pc.current_party_hp[active_pokemon] > 0)
     {
-      if((rand() % 100) <= 20) critical = 1.5;
+      if(rng_range(&rng[rng_battle], 100) <= 20) critical = 1.5;
       else critical = 1;
       io_top_clear();
       mvprintw(0, 0, "%s%s%s used %s!", world.pc.party[active_pokemon]->is_shiny() ? "*" : "", world.pc.party[active_pokemon]->get_species(), world.pc.party[active_pokemon]->is_shiny() ? "*" : "", world.pc.party[active_pokemon]->get_move(move_index));
       getch();
-      if((rand() % 100) < world.pc.party[active_pokemon]->get_move_accuracy(move_index))
+      if(rng_range(&rng[rng_battle], 100) < world.pc.party[active_pokemon]->get_move_accuracy(move_index))
       {
-        pc_damage = ((((2 * world.pc.party[active_pokemon]->get_level() / 5) + 2) * world.pc.party[active_pokemon]->get_move_power(move_index) * (world.pc.party[active_pokemon]->get_atk() / world.pc.party[active_pokemon]->get_def()) /50) + 2) * critical * 3 * world.pc.party[active_pokemon]->get_level() / 3; // no stab, no type
+        pc_damage = io_move_damage(world.pc.party[active_pokemon], move_index, p, critical);
         if(critical == 1.5)
         {
           io_top_clear();
@@ -1605,7 +1609,7 @@ bool black_out()
     io_top_clear();
     mvprintw(0, 0, "You ran out of useable Pokemon!");
     getch();
-    money = rand() % 100 + 200;
+    money = rng_range(&rng[rng_battle], 100) + 200;
     if((world.pc.wallet - money) < 0) money = world.pc.wallet;
     world.pc.wallet = 0;
     io_top_clear();
@@ -1677,11 +1681,10 @@ void io_battle(character *aggressor, character *defender)
 
 void io_trainer_battle()
 {
-  pokemon *opp[6];
-  int current_opp_hp[6];
+  pokemon *opp[7];
+  int current_opp_hp[7];
   int pc_active_pokemon = 0;
   int opp_active_pokemon = 0;
-  pokemon *p;
   int opp_total;
   int money;
   int md = (abs(world.cur_idx[dim_x] - (WORLD_SIZE / 2)) +
@@ -1707,18 +1710,19 @@ void io_trainer_battle()
   if (maxl > 100) {
     maxl = 100;
   }
+  for(unsigned i = 0; i < sizeof (current_opp_hp) / sizeof (current_opp_hp[0]); i++)
+  {
+    current_opp_hp[i] = -1;
+  }
   opp_total = 1;
   for(int i = 0; i < 6; i++)
   {
-    current_opp_hp[i] = -1;
-    if(rand() % 100 <= 60) opp_total++;
+    if(rng_range(&rng[rng_battle], 100) <= 60) opp_total++;
   }
+  generate_pokemon_batch(opp_total, minl, maxl, opp);
   for(int j = 0; j < opp_total; j++)
   {
-    p = new pokemon(rand() % (maxl - minl + 1) + minl);
-    opp[j] = (pokemon *) malloc(sizeof(*opp[j]));
-    memcpy(opp[j], p, sizeof(*opp[j]));
-    current_opp_hp[j] = p->get_hp();
+    current_opp_hp[j] = opp[j]->get_hp();
   }
   //bool end = false;
   bool loop = true;
@@ -1753,7 +1757,7 @@ void io_trainer_battle()
             mvprintw(0, 0, "The opponent's %s%s%s fainted!", opp[opp_active_pokemon]->is_shiny() ? "*" : "", opp[opp_active_pokemon]->get_species(), opp[opp_active_pokemon]->is_shiny() ? "*" : "");
             getch();
             io_top_clear();
-            exp = (rand() % 75 + 10) * opp[opp_active_pokemon]->get_level();
+            exp = (rng_range(&rng[rng_battle], 75) + 10) * opp[opp_active_pokemon]->get_level();
             mvprintw(0, 0, "Your %s%s%s gained %d exp!", world.pc.party[pc_active_pokemon]->is_shiny() ? "*" : "", world.pc.party[pc_active_pokemon]->get_species(), world.pc.party[pc_active_pokemon]->is_shiny() ? "*" : "", exp);
             getch();
             levels = world.pc.party[pc_active_pokemon]->gain_exp(exp);
@@ -1772,7 +1776,7 @@ void io_trainer_battle()
             }
             else
             {
-              money = rand() % 400 + 150;
+              money = rng_range(&rng[rng_battle], 400) + 150;
               io_top_clear();
               mvprintw(0, 0, "The opponent ran out of useable Pokemon! You win this battle!");
               io_display();
@@ -2346,8 +2350,10 @@ void io_trainer_battle()
     }while(loop);
   //}
   
-  // Later on, don't delete if captured
-  delete p;
+  for(int j = 0; j < opp_total; j++)
+  {
+    delete opp[j];
+  }
 }
 
 uint32_t move_pc_dir(uint32_t input, pair_t dest)
@@ -2597,7 +2603,7 @@ void io_handle_input(pair_t dest)
 
 
 
-void io_encounter_pokemon()
+void io_encounter_pokemon(int species)
 {
   pokemon *p;
   int md = (abs(world.cur_idx[dim_x] - (WORLD_SIZE / 2)) +
@@ -2624,7 +2630,7 @@ void io_encounter_pokemon()
     maxl = 100;
   }
 
-  p = new pokemon(rand() % (maxl - minl + 1) + minl);
+  p = new pokemon(rand_range(&rng[rng_pokemon], minl, maxl), species);
 
   //bool end = false;
   bool loop = true;
@@ -2658,7 +2664,7 @@ void io_encounter_pokemon()
             mvprintw(0, 0, "The wild %s%s%s fainted!", p->is_shiny() ? "*" : "", p->get_species(), p->is_shiny() ? "*" : "");
             getch();
             io_top_clear();
-            exp = (rand() % 75 + 10) * p->get_level();
+            exp = (rng_range(&rng[rng_battle], 75) + 10) * p->get_level();
             mvprintw(0, 0, "Your %s%s%s gained %d exp!", world.pc.party[active_pokemon]->is_shiny() ? "*" : "", world.pc.party[active_pokemon]->get_species(), world.pc.party[active_pokemon]->is_shiny() ? "*" : "", exp);
             getch();
             levels = world.pc.party[active_pokemon]->gain_exp(exp);
@@ -2954,7 +2960,7 @@ void io_encounter_pokemon()
           }
           break;
         case '3': //Run
-          if(rand() % 256 < ((world.pc.party[active_pokemon]->get_speed() * 32)/((p->get_speed()/4) % 256) + 30 * attempts))
+          if(rng_range(&rng[rng_battle], 256) < ((world.pc.party[active_pokemon]->get_speed() * 32)/((p->get_speed()/4) % 256) + 30 * attempts))
           {
             loop = false;
             refresh();
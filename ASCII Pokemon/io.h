@@ -12,7 +12,7 @@ void io_queue_message(const char *format, ...);
 void io_battle(character_t *aggressor, character_t *defender);
 void io_trainer_battle();
 void io_choose_starter(void);
-void io_encounter_pokemon(void);
+void io_encounter_pokemon(int species);
 int io_forget_a_move(const char *species, const char *move1, const char *move2, const char *move3, const char *move4, const char *move5);
 
 #endif
@@ -10,10 +10,13 @@
 #include <unistd.h>
 
 #include "heap.h"
+#include "dheap.h"
 #include "pokemon.h"
 #include "poke327.h"
 #include "io.h"
 #include "db_parse.h"
+#include "timing.h"
+#include "encounter.h"
 
 typedef struct queue_node {
   int x, y;
@@ -33,21 +36,24 @@ pair_t all_dirs[8] = {
   {  1,  1 },
 };
 
-static int32_t path_cmp(const void *key, const void *with) {
-  return ((path_t *) key)->cost - ((path_t *) with)->cost;
-}
-
 static int32_t edge_penalty(int8_t x, int8_t y)
 {
   return (x == 1 || y == 1 || x == MAP_X - 2 || y == MAP_Y - 2) ? 2 : 1;
 }
 
+/* The costs multiply, so there's no bucket queue for this; it's a   *
+ * dheap on the cells' y * MAP_X + x, with the costs kept in it too. */
+#define path_cell(x, y) ((y) * MAP_X + (x))
+
 static void dijkstra_path(map_t *m, pair_t from, pair_t to)
 {
   static path_t path[MAP_Y][MAP_X], *p;
+  static uint32_t items[(MAP_Y - 2) * (MAP_X - 2)];
+  static int32_t keys[(MAP_Y - 2) * (MAP_X - 2)];
+  static dheap<int32_t, std::less<int32_t>, PATH_HEAP_ARITY> h(MAP_X * MAP_Y);
   static uint32_t initialized = 0;
-  heap_t h;
   int32_t x, y;
+  uint32_t c, n;
 
   if (!initialized) {
     for (y = 0; y < MAP_Y; y++) {
@@ -56,6 +62,11 @@ static void dijkstra_path(map_t *m, pair_t from, pair_t to)
         path[y][x].pos[dim_x] = x;
       }
     }
+    for (n = 0, y = 1; y < MAP_Y - 1; y++) {
+      for (x = 1; x < MAP_X - 1; x++) {
+        items[n++] = path_cell(x, y);
+      }
+    }
     initialized = 1;
   }
   
@@ -67,16 +78,16 @@ static void dijkstra_path(map_t *m, pair_t from, pair_t to)
 
   path[from[dim_y]][from[dim_x]].cost = 0;
 
-  heap_init(&h, path_cmp, NULL);
-
-  for (y = 1; y < MAP_Y - 1; y++) {
+  for (n = 0, y = 1; y < MAP_Y - 1; y++) {
     for (x = 1; x < MAP_X - 1; x++) {
-      path[y][x].hn = heap_insert(&h, &path[y][x]);
+      keys[n++] = path[y][x].cost;
     }
   }
+  h.build(items, keys, n);
 
-  while ((p = (path_t *) heap_remove_min(&h))) {
-    p->hn = NULL;
+  while (!h.empty()) {
+    c = h.pop();
+    p = &path[c / MAP_X][c % MAP_X];
 
     if ((p->pos[dim_y] == to[dim_y]) && p->pos[dim_x] == to[dim_x]) {
       for (x = to[dim_x], y = to[dim_y];
@@ -85,11 +96,11 @@ static void dijkstra_path(map_t *m, pair_t from, pair_t to)
         mapxy(x, y) = ter_path;
         heightxy(x, y) = 0;
       }
-      heap_delete(&h);
+      h.clear();
       return;
     }
 
-    if ((path[p->pos[dim_y] - 1][p->pos[dim_x]    ].hn) &&
+    if ((h.contains(path_cell(p->pos[dim_x], p->pos[dim_y] - 1))) &&
         (path[p->pos[dim_y] - 1][p->pos[dim_x]    ].cost >
          ((p->cost + heightpair(p->pos)) *
           edge_penalty(p->pos[dim_x], p->pos[dim_y] - 1)))) {
@@ -98,10 +109,10 @@ static void dijkstra_path(map_t *m, pair_t from, pair_t to)
          edge_penalty(p->pos[dim_x], p->pos[dim_y] - 1));
       path[p->pos[dim_y] - 1][p->pos[dim_x]    ].from[dim_y] = p->pos[dim_y];
       path[p->pos[dim_y] - 1][p->pos[dim_x]    ].from[dim_x] = p->pos[dim_x];
-      heap_decrease_key_no_replace(&h, path[p->pos[dim_y] - 1]
-                                           [p->pos[dim_x]    ].hn);
+      h.decrease(path_cell(p->pos[dim_x], p->pos[dim_y] - 1),
+                 path[p->pos[dim_y] - 1][p->pos[dim_x]    ].cost);
     }
-    if ((path[p->pos[dim_y]    ][p->pos[dim_x] - 1].hn) &&
+    if ((h.contains(path_cell(p->pos[dim_x] - 1, p->pos[dim_y]))) &&
         (path[p->pos[dim_y]    ][p->pos[dim_x] - 1].cost >
          ((p->cost + heightpair(p->pos)) *
           edge_penalty(p->pos[dim_x] - 1, p->pos[dim_y])))) {
@@ -110,10 +121,10 @@ static void dijkstra_path(map_t *m, pair_t from, pair_t to)
          edge_penalty(p->pos[dim_x] - 1, p->pos[dim_y]));
       path[p->pos[dim_y]    ][p->pos[dim_x] - 1].from[dim_y] = p->pos[dim_y];
       path[p->pos[dim_y]    ][p->pos[dim_x] - 1].from[dim_x] = p->pos[dim_x];
-      heap_decrease_key_no_replace(&h, path[p->pos[dim_y]    ]
-                                           [p->pos[dim_x] - 1].hn);
+      h.decrease(path_cell(p->pos[dim_x] - 1, p->pos[dim_y]),
+                 path[p->pos[dim_y]    ][p->pos[dim_x] - 1].cost);
     }
-    if ((path[p->pos[dim_y]    ][p->pos[dim_x] + 1].hn) &&
+    if ((h.contains(path_cell(p->pos[dim_x] + 1, p->pos[dim_y]))) &&
         (path[p->pos[dim_y]    ][p->pos[dim_x] + 1].cost >
          ((p->cost + heightpair(p->pos)) *
           edge_penalty(p->pos[dim_x] + 1, p->pos[dim_y])))) {
@@ -122,10 +133,10 @@ static void dijkstra_path(map_t *m, pair_t from, pair_t to)
          edge_penalty(p->pos[dim_x] + 1, p->pos[dim_y]));
       path[p->pos[dim_y]    ][p->pos[dim_x] + 1].from[dim_y] = p->pos[dim_y];
       path[p->pos[dim_y]    ][p->pos[dim_x] + 1].from[dim_x] = p->pos[dim_x];
-      heap_decrease_key_no_replace(&h, path[p->pos[dim_y]    ]
-                                           [p->pos[dim_x] + 1].hn);
+      h.decrease(path_cell(p->pos[dim_x] + 1, p->pos[dim_y]),
+                 path[p->pos[dim_y]    ][p->pos[dim_x] + 1].cost);
     }
-    if ((path[p->pos[dim_y] + 1][p->pos[dim_x]    ].hn) &&
+    if ((h.contains(path_cell(p->pos[dim_x], p->pos[dim_y] + 1))) &&
         (path[p->pos[dim_y] + 1][p->pos[dim_x]    ].cost >
          ((p->cost + heightpair(p->pos)) *
           edge_penalty(p->pos[dim_x], p->pos[dim_y] + 1)))) {
@@ -134,8 +145,8 @@ static void dijkstra_path(map_t *m, pair_t from, pair_t to)
          edge_penalty(p->pos[dim_x], p->pos[dim_y] + 1));
       path[p->pos[dim_y] + 1][p->pos[dim_x]    ].from[dim_y] = p->pos[dim_y];
       path[p->pos[dim_y] + 1][p->pos[dim_x]    ].from[dim_x] = p->pos[dim_x];
-      heap_decrease_key_no_replace(&h, path[p->pos[dim_y] + 1]
-                                           [p->pos[dim_x]    ].hn);
+      h.decrease(path_cell(p->pos[dim_x], p->pos[dim_y] + 1),
+                 path[p->pos[dim_y] + 1][p->pos[dim_x]    ].cost);
     }
   }
 }
@@ -252,8 +263,8 @@ static int smooth_height(map_t *m)
   /* Seed with some values */
   for (i = 1; i < 255; i += 20) {
     do {
-      x = rand() % MAP_X;
-      y = rand() % MAP_Y;
+      x = rng_range(&rng[rng_map], MAP_X);
+      y = rng_range(&rng[rng_map], MAP_Y);
     } while (height[y][x]);
     height[y][x] = i;
     if (i == 1) {
@@ -399,8 +410,8 @@ static int smooth_height(map_t *m)
 static void find_building_location(map_t *m, pair_t p)
 {
   do {
-    p[dim_x] = rand() % (MAP_X - 3) + 1;
-    p[dim_y] = rand() % (MAP_Y - 3) + 1;
+    p[dim_x] = rng_range(&rng[rng_map], MAP_X - 3) + 1;
+    p[dim_y] = rng_range(&rng[rng_map], MAP_Y - 3) + 1;
 
     if ((((mapxy(p[dim_x] - 1, p[dim_y]    ) == ter_path)     &&
           (mapxy(p[dim_x] - 1, p[dim_y] + 1) == ter_path))    ||
@@ -463,10 +474,10 @@ static int map_terrain(map_t *m, int8_t n, int8_t s, int8_t e, int8_t w)
   terrain_type_t type;
   int added_current = 0;
   
-  num_grass = rand() % 4 + 2;
-  num_clearing = rand() % 4 + 2;
-  num_mountain = rand() % 2 + 1;
-  num_forest = rand() % 2 + 1;
+  num_grass = rng_range(&rng[rng_map], 4) + 2;
+  num_clearing = rng_range(&rng[rng_map], 4) + 2;
+  num_mountain = rng_range(&rng[rng_map], 2) + 1;
+  num_forest = rng_range(&rng[rng_map], 2) + 1;
   num_total = num_grass + num_clearing + num_mountain + num_forest;
 
   memset(&m->map, 0, sizeof (m->map));
@@ -474,8 +485,8 @@ static int map_terrain(map_t *m, int8_t n, int8_t s, int8_t e, int8_t w)
   /* Seed with some values */
   for (i = 0; i < num_total; i++) {
     do {
-      x = rand() % MAP_X;
-      y = rand() % MAP_Y;
+      x = rng_range(&rng[rng_map], MAP_X);
+      y = rng_range(&rng[rng_map], MAP_Y);
     } while (m->map[y][x]);
     if (i == 0) {
       type = ter_grass;
@@ -512,7 +523,7 @@ static int map_terrain(map_t *m, int8_t n, int8_t s, int8_t e, int8_t w)
     i = m->map[y][x];
     
     if (x - 1 >= 0 && !m->map[y][x - 1]) {
-      if ((rand() % 100) < 80) {
+      if (rng_percent(&rng[rng_map], 80)) {
         m->map[y][x - 1] = (terrain_type_t) i;
         tail->next = (queue_node_t *) malloc(sizeof (*tail));
         tail = tail->next;
@@ -531,7 +542,7 @@ static int map_terrain(map_t *m, int8_t n, int8_t s, int8_t e, int8_t w)
     }
 
     if (y - 1 >= 0 && !m->map[y - 1][x]) {
-      if ((rand() % 100) < 20) {
+      if (rng_percent(&rng[rng_map], 20)) {
         m->map[y - 1][x] = (terrain_type_t) i;
         tail->next = (queue_node_t *) malloc(sizeof (*tail));
         tail = tail->next;
@@ -550,7 +561,7 @@ static int map_terrain(map_t *m, int8_t n, int8_t s, int8_t e, int8_t w)
     }
 
     if (y + 1 < MAP_Y && !m->map[y + 1][x]) {
-      if ((rand() % 100) < 20) {
+      if (rng_percent(&rng[rng_map], 20)) {
         m->map[y + 1][x] = (terrain_type_t) i;
         tail->next = (queue_node_t *) malloc(sizeof (*tail));
         tail = tail->next;
@@ -569,7 +580,7 @@ static int map_terrain(map_t *m, int8_t n, int8_t s, int8_t e, int8_t w)
     }
 
     if (x + 1 < MAP_X && !m->map[y][x + 1]) {
-      if ((rand() % 100) < 80) {
+      if (rng_percent(&rng[rng_map], 80)) {
         m->map[y][x + 1] = (terrain_type_t) i;
         tail->next = (queue_node_t *) malloc(sizeof (*tail));
         tail = tail->next;
@@ -639,9 +650,11 @@ static int place_boulders(map_t *m)
   int i;
   int x, y;
 
-  for (i = 0; i < MIN_BOULDERS || rand() % 100 < BOULDER_PROB; i++) {
-    y = rand() % (MAP_Y - 2) + 1;
-    x = rand() % (MAP_X - 2) + 1;
+  for (i = 0;
+       i < MIN_BOULDERS || rng_percent(&rng[rng_map], BOULDER_PROB);
+       i++) {
+    y = rng_range(&rng[rng_map], MAP_Y - 2) + 1;
+    x = rng_range(&rng[rng_map], MAP_X - 2) + 1;
     if (m->map[y][x] != ter_forest && m->map[y][x] != ter_path) {
       m->map[y][x] = ter_boulder;
     }
@@ -655,9 +668,9 @@ static int place_trees(map_t *m)
   int i;
   int x, y;
   
-  for (i = 0; i < MIN_TREES || rand() % 100 < TREE_PROB; i++) {
-    y = rand() % (MAP_Y - 2) + 1;
-    x = rand() % (MAP_X - 2) + 1;
+  for (i = 0; i < MIN_TREES || rng_percent(&rng[rng_map], TREE_PROB); i++) {
+    y = rng_range(&rng[rng_map], MAP_Y - 2) + 1;
+    x = rng_range(&rng[rng_map], MAP_X - 2) + 1;
     if (m->map[y][x] != ter_mountain && m->map[y][x] != ter_path) {
       m->map[y][x] = ter_tree;
     }
@@ -668,8 +681,8 @@ static int place_trees(map_t *m)
 
 void rand_pos(pair_t pos)
 {
-  pos[dim_x] = (rand() % (MAP_X - 2)) + 1;
-  pos[dim_y] = (rand() % (MAP_Y - 2)) + 1;
+  pos[dim_x] = rng_range(&rng[rng_map], MAP_X - 2) + 1;
+  pos[dim_y] = rng_range(&rng[rng_map], MAP_Y - 2) + 1;
 }
 
 void new_hiker()
@@ -744,7 +757,7 @@ void new_char_other()
   c->pos[dim_y] = pos[dim_y];
   c->pos[dim_x] = pos[dim_x];
   c->ctype = char_other;
-  switch (rand() % 4) {
+  switch (rng_range(&rng[rng_map], 4)) {
   case 0:
     c->mtype = move_pace;
     c->symbol = 'p';
@@ -762,7 +775,7 @@ void new_char_other()
     c->symbol = 'n';
     break;
   }
-  rand_dir(c->dir);
+  rand_dir(&rng[rng_map], c->dir);
   c->defeated = 0;
   c->next_turn = 0;
   heap_insert(&world.cur_map->turn, c);
@@ -778,7 +791,7 @@ void place_characters()
   new_rival();
   do {
     //higher probability of non- hikers and rivals
-    switch(rand() % 10) {
+    switch(rng_range(&rng[rng_map], 10)) {
     case 0:
       new_hiker();
       break;
@@ -794,7 +807,7 @@ void place_characters()
      * impossible (or very difficult) to continue to add, so we abort if *
      * we've tried MAX_TRAINER_TRIES times.                              */
   } while (++world.cur_map->num_trainers < MIN_TRAINERS ||
-           ((rand() % 100) < ADD_TRAINER_PROB));
+           rng_percent(&rng[rng_map], ADD_TRAINER_PROB));
 }
 
 void init_pc()
@@ -802,8 +815,8 @@ void init_pc()
   int x, y;
 
   do {
-    x = rand() % (MAP_X - 2) + 1;
-    y = rand() % (MAP_Y - 2) + 1;
+    x = rng_range(&rng[rng_map], MAP_X - 2) + 1;
+    y = rng_range(&rng[rng_map], MAP_Y - 2) + 1;
   } while (world.cur_map->map[y][x] != ter_path);
 
   world.pc.pos[dim_x] = x;
@@ -839,6 +852,28 @@ void place_pc()
   }
 }
 
+/* Every turn moves its character's next turn on by the cost of the *
+ * move, so the queue's keys never step by more than the dearest     *
+ * move that anyone can make.                                        */
+static void init_turn_queue(heap_t *h)
+{
+  int32_t max;
+  int c;
+
+  for (max = 0, c = 0; c < num_character_types; c++) {
+    if (max_move_cost((character_type_t) c) > max) {
+      max = max_move_cost((character_type_t) c);
+    }
+  }
+
+  if (max < QUEUE_MAX_BUCKETS) {
+    heap_init_buckets(h, max, char_turn_key, delete_character);
+  } else {
+    heap_init_dary(h, PATH_HEAP_ARITY, cmp_char_turns, delete_character);
+  }
+  heap_set_arena(h, &world.turn_arena);
+}
+
 // New map expects cur_idx to refer to the index to be generated.  If that
 // map has already been generated then the only thing this does is set
 // cur_map.
@@ -847,6 +882,7 @@ int new_map(int teleport)
   int d, p;
   int e, w, n, s;
   int x, y;
+  int phase, step;
   
   if (world.world[world.cur_idx[dim_y]][world.cur_idx[dim_x]]) {
     world.cur_map = world.world[world.cur_idx[dim_y]][world.cur_idx[dim_x]];
@@ -855,56 +891,73 @@ int new_map(int teleport)
     return 0;
   }
 
+  phase = timing_begin("new_map");
+
   world.cur_map                                             =
     world.world[world.cur_idx[dim_y]][world.cur_idx[dim_x]] =
     (map_t *) malloc(sizeof (*world.cur_map));
 
+  // Everything below that's random about this map comes from here.
+  rng_seed_map(world.cur_idx[dim_x], world.cur_idx[dim_y]);
+
+  step = timing_begin("smooth_height");
   smooth_height(world.cur_map);
+  timing_end(step);
   
   if (!world.cur_idx[dim_y]) {
     n = -1;
   } else if (world.world[world.cur_idx[dim_y] - 1][world.cur_idx[dim_x]]) {
     n = world.world[world.cur_idx[dim_y] - 1][world.cur_idx[dim_x]]->s;
   } else {
-    n = 3 + rand() % (MAP_X - 6);
+    n = 3 + rng_range(&rng[rng_map], MAP_X - 6);
   }
   if (world.cur_idx[dim_y] == WORLD_SIZE - 1) {
     s = -1;
   } else if (world.world[world.cur_idx[dim_y] + 1][world.cur_idx[dim_x]]) {
     s = world.world[world.cur_idx[dim_y] + 1][world.cur_idx[dim_x]]->n;
   } else  {
-    s = 3 + rand() % (MAP_X - 6);
+    s = 3 + rng_range(&rng[rng_map], MAP_X - 6);
   }
   if (!world.cur_idx[dim_x]) {
     w = -1;
   } else if (world.world[world.cur_idx[dim_y]][world.cur_idx[dim_x] - 1]) {
     w = world.world[world.cur_idx[dim_y]][world.cur_idx[dim_x] - 1]->e;
   } else {
-    w = 3 + rand() % (MAP_Y - 6);
+    w = 3 + rng_range(&rng[rng_map], MAP_Y - 6);
   }
   if (world.cur_idx[dim_x] == WORLD_SIZE - 1) {
     e = -1;
   } else if (world.world[world.cur_idx[dim_y]][world.cur_idx[dim_x] + 1]) {
     e = world.world[world.cur_idx[dim_y]][world.cur_idx[dim_x] + 1]->w;
   } else {
-    e = 3 + rand() % (MAP_Y - 6);
+    e = 3 + rng_range(&rng[rng_map], MAP_Y - 6);
   }
   
+  step = timing_begin("map_terrain");
   map_terrain(world.cur_map, n, s, e, w);
+  timing_end(step);
      
+  step = timing_begin("place_boulders");
   place_boulders(world.cur_map);
+  timing_end(step);
+  step = timing_begin("place_trees");
   place_trees(world.cur_map);
+  timing_end(step);
+  step = timing_begin("build_paths");
   build_paths(world.cur_map);
+  timing_end(step);
+  step = timing_begin("place_buildings");
   d = (abs(world.cur_idx[dim_x] - (WORLD_SIZE / 2)) +
        abs(world.cur_idx[dim_y] - (WORLD_SIZE / 2)));
   p = d > 200 ? 5 : (50 - ((45 * d) / 200));
   //  printf("d=%d, p=%d\n", d, p);
-  if ((rand() % 100) < p || !d) {
+  if (rng_percent(&rng[rng_map], p) || !d) {
     place_pokemart(world.cur_map);
   }
-  if ((rand() % 100) < p || !d) {
+  if (rng_percent(&rng[rng_map], p) || !d) {
     place_center(world.cur_map);
   }
+  timing_end(step);
 
   for (y = 0; y < MAP_Y; y++) {
     for (x = 0; x < MAP_X; x++) {
@@ -912,7 +965,7 @@ int new_map(int teleport)
     }
   }
 
-  heap_init(&world.cur_map->turn, cmp_char_turns, delete_character);
+  init_turn_queue(&world.cur_map->turn);
 
   if ((world.cur_idx[dim_x] == WORLD_SIZE / 2) &&
       (world.cur_idx[dim_y] == WORLD_SIZE / 2)) {
@@ -921,22 +974,30 @@ int new_map(int teleport)
     place_pc();
   }
 
+  /* There's no rival_dist test here: the distances are still the last *
+   * map's until pathfind() runs below, and the trainers it places are *
+   * put only where they can reach the PC.                             */
   if (teleport) {
     do {
       world.cur_map->cmap[world.pc.pos[dim_y]][world.pc.pos[dim_x]] = NULL;
-      world.pc.pos[dim_x] = rand_range(1, MAP_X - 2);
-      world.pc.pos[dim_y] = rand_range(1, MAP_Y - 2);
+      world.pc.pos[dim_x] = rand_range(&rng[rng_world], 1, MAP_X - 2);
+      world.pc.pos[dim_y] = rand_range(&rng[rng_world], 1, MAP_Y - 2);
     } while (world.cur_map->cmap[world.pc.pos[dim_y]][world.pc.pos[dim_x]] ||
              (move_cost[char_pc][world.cur_map->map[world.pc.pos[dim_y]]
                                                    [world.pc.pos[dim_x]]] ==
-              INT_MAX)                                                      ||
-             world.rival_dist[world.pc.pos[dim_y]][world.pc.pos[dim_x]] < 0);
+              INT_MAX));
     world.cur_map->cmap[world.pc.pos[dim_y]][world.pc.pos[dim_x]] = &world.pc;
   }
 
+  step = timing_begin("pathfind");
   pathfind(world.cur_map);
+  timing_end(step);
   
+  step = timing_begin("place_characters");
   place_characters();
+  timing_end(step);
+
+  timing_end(phase);
 
   return 0;
 }
@@ -994,10 +1055,15 @@ static void print_map()
 */
 
 // The world is global because of its size, so init_world is parameterless
+// Turn queues hold one map's trainers, a few dozen at most.
+#define TURN_ARENA_CHUNK 64
+
 void init_world()
 {
   world.quit = 0;
   world.cur_idx[dim_x] = world.cur_idx[dim_y] = WORLD_SIZE / 2;
+  heap_arena_init(&world.path_arena, MAP_X * MAP_Y);
+  heap_arena_init(&world.turn_arena, TURN_ARENA_CHUNK);
   new_map(0);
 }
 
@@ -1109,8 +1175,9 @@ void game_loop()
 
     if (is_pc && (c->pos[dim_y] != d[dim_y] || c->pos[dim_x] != d[dim_x]) &&
         (world.cur_map->map[d[dim_y]][d[dim_x]] == ter_grass) &&
-        (rand() % 100 < ENCOUNTER_PROB)) {
-      io_encounter_pokemon();
+        rng_percent(&rng[rng_world], ENCOUNTER_PROB)) {
+      io_encounter_pokemon(encounter_species(world.cur_map->map[d[dim_y]]
+                                                               [d[dim_x]]));
     }
 
     c->pos[dim_y] = d[dim_y];
@@ -1122,17 +1189,32 @@ void game_loop()
 
 void usage(char *s)
 {
-  fprintf(stderr, "Usage: %s [-s|--seed <seed>]\n", s);
+  fprintf(stderr, "Usage: %s [-s|--seed <seed>] [--timings]\n"
+          "  --timings  On exit, print where the time went, and write the\n"
+          "             same report as JSON to timings.json\n", s);
 
   exit(1);
 }
 
+static void print_arena_stats(const char *name, const heap_arena_t *a)
+{
+  printf("%s: %lu allocs, %lu frees, %lu live, %lu chunks, %lu arrays\n",
+         name,
+         (unsigned long) a->stats.allocs,
+         (unsigned long) a->stats.frees,
+         (unsigned long) a->stats.live,
+         (unsigned long) a->stats.chunks,
+         (unsigned long) a->stats.arrays);
+}
+
 int main(int argc, char *argv[])
 {
   struct timeval tv;
   uint32_t seed;
   int long_arg;
   int do_seed;
+  int phase;
+  FILE *f;
   //  char c;
   //  int x, y;
   int i;
@@ -1156,6 +1238,12 @@ int main(int argc, char *argv[])
           }
           do_seed = 0;
           break;
+        case 't':
+          if (!long_arg || strcmp(argv[i], "-timings")) {
+            usage(argv[0]);
+          }
+          timing_enable();
+          break;
         default:
           usage(argv[0]);
         }
@@ -1174,14 +1262,24 @@ int main(int argc, char *argv[])
 
   printf("Using seed: %u\n", seed);
   
-  srand(seed);
+  rng_init(seed);
 
+  phase = timing_begin("db_parse");
   db_parse(false);
+  timing_end(phase);
+
+  phase = timing_begin("encounter tables");
+  encounter_init();
+  timing_end(phase);
    
   
+  phase = timing_begin("io_init_terminal");
   io_init_terminal();
+  timing_end(phase);
   
+  phase = timing_begin("init_world");
   init_world();
+  timing_end(phase);
 
   /* print_hiker_dist(); */
   
@@ -1246,11 +1344,28 @@ int main(int argc, char *argv[])
 
   */
 
+  phase = timing_begin("game_loop");
   game_loop();
+  timing_end(phase);
   
   delete_world();
 
   io_reset_terminal();
+
+  if (timing_enabled) {
+    timing_report(stdout);
+    printf("pokemon pool: %lu allocs, %lu frees, %lu live, %lu slabs\n",
+           (unsigned long) pokemon_pool_stats()->allocs,
+           (unsigned long) pokemon_pool_stats()->frees,
+           (unsigned long) pokemon_pool_stats()->live,
+           (unsigned long) pokemon_pool_stats()->slabs);
+    print_arena_stats("path heaps", &world.path_arena);
+    print_arena_stats("turn queues", &world.turn_arena);
+    if ((f = fopen("timings.json", "w"))) {
+      timing_report_json(f);
+      fclose(f);
+    }
+  }
   
   return 0;
 }
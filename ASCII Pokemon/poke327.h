@@ -7,14 +7,16 @@
 # include "heap.h"
 #include "pokemon.h"
 # include "pair.h"
+# include "rng.h"
 
 /* Returns true if random float in [0,1] is less than *
- * numerator/denominator.  Uses only integer math.    */
-# define rand_under(numerator, denominator) \
-  (rand() < ((RAND_MAX / denominator) * numerator))
+ * numerator/denominator.  Uses only integer math.    *
+ * r is the rng stream to draw from (see rng.h).       */
+# define rand_under(r, numerator, denominator) \
+  (rng_u32(r) < ((UINT32_MAX / denominator) * numerator))
 
 /* Returns random integer in [min, max]. */
-# define rand_range(min, max) ((rand() % (((max) + 1) - (min))) + (min))
+# define rand_range(r, min, max) (rng_range(r, ((max) + 1) - (min)) + (min))
 
 # define UNUSED(f) ((void) f)
 
@@ -99,6 +101,7 @@ class pc : public character {
  * in world without including character.h in poke327.h                 */
 
 int32_t cmp_char_turns(const void *key, const void *with);
+int32_t char_turn_key(const void *v);
 void delete_character(void *v);
 
 int pc_move(char);
@@ -106,6 +109,8 @@ int pc_move(char);
 extern const char *char_type_name[num_character_types];
 
 extern int32_t move_cost[num_character_types][num_terrain_types];
+// The most that any move of c's can cost, other than INT_MAX.
+int32_t max_move_cost(character_type_t c);
 
 typedef struct map {
   terrain_type_t map[MAP_Y][MAP_X];
@@ -130,6 +135,11 @@ typedef struct world {
   class pc pc;
   int quit;
   int add_trainer_prob;
+  /* Every pathfinding heap and turn queue takes its nodes from one of *
+   * these, so that steady-state play makes no allocator calls for     *
+   * them.  Like the pokemon pool, they're never given back.           */
+  heap_arena_t path_arena;
+  heap_arena_t turn_arena;
 } world_t;
 
 /* Even unallocated, a WORLD_SIZE x WORLD_SIZE array of pointers is a very *
@@ -138,12 +148,23 @@ extern world_t world;
 
 extern pair_t all_dirs[8];
 
-#define rand_dir(dir) {     \
-  int _i = rand() & 0x7;    \
+#define rand_dir(r, dir) {  \
+  int _i = rng_u32(r) >> 29; \
   dir[0] = all_dirs[_i][0]; \
   dir[1] = all_dirs[_i][1]; \
 }
 
+/* pathfind() and the turn queues step by move costs, so they use    *
+ * bucket queues (see heap.h) with as many buckets as the dearest     *
+ * move, up to QUEUE_MAX_BUCKETS; past that, they use d-ary heaps of *
+ * PATH_HEAP_ARITY.  Binary heap_t measures ahead of 4-ary on         *
+ * pathfind().  dijkstra_path(), whose costs multiply, uses a dheap   *
+ * (see dheap.h) of the same arity; on the same workload dheap comes  *
+ * out within noise at anything from 2 to 8, so there's no call for   *
+ * an arity of its own.                                               */
+#define QUEUE_MAX_BUCKETS 1024
+#define PATH_HEAP_ARITY 2
+
 typedef struct path {
   heap_node_t *hn;
   uint8_t pos[2];
@@ -1,96 +1,189 @@
 #include <cstdlib>
-#include <algorithm>
+#include <climits>
+#include <cassert>
+#include <new>
 
 #include "pokemon.h"
 #include "db_parse.h"
 #include "io.h"
+#include "rng.h"
 
-pokemon_species_db *s;
-static bool operator<(const levelup_move &f, const levelup_move &s)
+/* Every encounter and battle makes pokemon, and most of them are gone *
+ * a few turns later, so rather than going to the heap for each one we *
+ * carve them out of slabs and keep the freed ones on a list.  Once the *
+ * pool is as big as the game has needed, new and delete are a couple  *
+ * of pointer moves.  Slabs are never given back.                       */
+#define POKEMON_SLAB 64
+
+typedef union pokemon_slot {
+  union pokemon_slot *next;
+  alignas(class pokemon) char object[sizeof (class pokemon)];
+} pokemon_slot_t;
+
+static pokemon_slot_t *free_slots;
+static pokemon_pool_stats_t pool_stats;
+
+void *pokemon::operator new(size_t size)
+{
+  pokemon_slot_t *slot;
+  int i;
+
+  assert(size == sizeof (pokemon));
+
+  if (!free_slots) {
+    if (!(slot = (pokemon_slot_t *) malloc(POKEMON_SLAB * sizeof (*slot)))) {
+      throw std::bad_alloc();
+    }
+    for (i = POKEMON_SLAB - 1; i >= 0; i--) {
+      slot[i].next = free_slots;
+      free_slots = slot + i;
+    }
+    pool_stats.slabs++;
+  }
+
+  slot = free_slots;
+  free_slots = slot->next;
+  pool_stats.allocs++;
+  pool_stats.live++;
+
+  return slot;
+}
+
+void pokemon::operator delete(void *p)
+{
+  pokemon_slot_t *slot = (pokemon_slot_t *) p;
+
+  if (slot) {
+    slot->next = free_slots;
+    free_slots = slot;
+    pool_stats.frees++;
+    pool_stats.live--;
+  }
+}
+
+const pokemon_pool_stats_t *pokemon_pool_stats()
 {
-  return ((f.level < s.level) || ((f.level == s.level) && f.move < s.move));
+  return &pool_stats;
 }
 
 pokemon::pokemon(int level) : level(level)
 {
+  uint64_t r0 = rng_next(&rng[rng_pokemon]);
+  uint64_t r1 = rng_next(&rng[rng_pokemon]);
 
-  unsigned i, j;
-  bool found;
-
-  // Subtract 1 because array is 1-indexed
-  pokemon_species_index = rand() % ((sizeof (species) /
-                                     sizeof (species[0])) - 1);
-  s = species + pokemon_species_index;
-  
-  if (!s->levelup_moves.size()) {
-    // We have never generated a pokemon of this species before, so we
-    // need to find it's level-up moveset and save it for next time.
-    for (i = 1; i < (sizeof (pokemon_moves) /
-                     sizeof (pokemon_moves[0])); i++) {
-      if (s->id == pokemon_moves[i].pokemon_id &&
-          pokemon_moves[i].pokemon_move_method_id == 1) {
-        for (found = false, j = 0; !found && j < s->levelup_moves.size(); j++) {
-          if (s->levelup_moves[j].move == pokemon_moves[i].move_id) {
-            found = true;
-          }
-        }
-        if (!found) {
-          s->levelup_moves.push_back({ pokemon_moves[i].level,
-                                       pokemon_moves[i].move_id });
-        }
-      }
-    }
+  // Row 0 is unused.
+  pokemon_species_index = 1 + rng_below(r1 >> 32,
+                                        db_num_rows(tbl_species) - 1);
+  generate(r0, r1);
+}
 
-    // s->levelup_moves now contains all of the moves this species can learn
-    // through leveling up.  Now we'll sort it by level to make that process
-    // simpler.
-    sort(s->levelup_moves.begin(), s->levelup_moves.end());
+pokemon::pokemon(int level, int species) : pokemon_species_index(species),
+                                           level(level)
+{
+  uint64_t r0 = rng_next(&rng[rng_pokemon]);
 
-    // Also initialize base stats while we're here
-    s->base_stat[0] = pokemon_stats[pokemon_species_index * 6 - 5].base_stat;
-    s->base_stat[1] = pokemon_stats[pokemon_species_index * 6 - 4].base_stat;
-    s->base_stat[2] = pokemon_stats[pokemon_species_index * 6 - 3].base_stat;
-    s->base_stat[3] = pokemon_stats[pokemon_species_index * 6 - 2].base_stat;
-    s->base_stat[4] = pokemon_stats[pokemon_species_index * 6 - 1].base_stat;
-    s->base_stat[5] = pokemon_stats[pokemon_species_index * 6 - 0].base_stat;
-  }
+  generate(r0, rng_next(&rng[rng_pokemon]));
+}
+
+/* Fills in everything but the level and species from 128 random     *
+ * bits: the low 24 of r0 are the six IVs, the next the gender and   *
+ * the 13 after that the shiny roll; r1's high half is left for      *
+ * picking the species and its low half picks the moves.             */
+void pokemon::generate(uint64_t r0, uint64_t r1)
+{
+  pick_moves(r1);
+  IVs = r0 & 0xffffff;
+  compute_stats();
+  exp = growth()[level];
+  flags = ((((r0 >> 25) & 0x1fff) == 0x1fff ? POKEMON_SHINY : 0) |
+           ((r0 >> 24) & 0x1 ? POKEMON_FEMALE : 0));
+}
+
+/* Up to two distinct moves that the species learns by its level, *
+ * chosen with the random bits in r.  A species' level-up moves are *
+ * already distinct, so the second is one of the other i - 1.       */
+void pokemon::pick_moves(uint32_t r)
+{
+  const levelup_move *lm;
+  int num_lm;
+  int i, j;
+
+  lm = db_levelup_moves(pokemon_species_index, &num_lm);
 
   // Get pokemon's move(s).
-  for (i = 0;
-       i < s->levelup_moves.size() && s->levelup_moves[i].level <= level;
-       i++)
+  for (i = 0; i < num_lm && lm[i].level <= level; i++)
     ;
 
   // 0 is an invalid index, since the array is 1 indexed.
   move_index[0] = move_index[1] = move_index[2] = move_index[3] = 0;
   // I don't think 0 moves is possible, but account for it to be safe
   if (i) {
-    move_index[0] = s->levelup_moves[rand() % i].move;
+    j = ((r & 0xffff) * i) >> 16;
+    move_index[0] = lm[j].move;
     if (i != 1) {
-      do {
-        j = rand() % i;
-      } while (s->levelup_moves[j].move == move_index[0]);
-      move_index[1] = s->levelup_moves[j].move;
+      move_index[1] = lm[(j + 1 + (((r >> 16) * (i - 1)) >> 16)) % i].move;
     }
   }
+}
+
+/* Every stat but HP is 5 + 2 * (base + IV) * level / 100, where      *
+ * base + IV is at most 255 + 15.  That's few enough values to keep   *
+ * them all, a row per level, so working out a pokemon's stats is six *
+ * reads from one row rather than six divisions.  HP gets a bonus on  *
+ * top.                                                               */
+#define POKEMON_MAX_STAT_BASE (UINT8_MAX + 0xf)
+
+struct stat_table_t {
+  uint16_t row[DB_MAX_LEVEL + 1][POKEMON_MAX_STAT_BASE + 1];
+};
+
+static constexpr stat_table_t make_stat_table()
+{
+  stat_table_t t = {};
+  int level = 0, b = 0;
 
-  // Calculate IVs
-  for (i = 0; i < 6; i++) {
-    IV[i] = rand() & 0xf;
-    effective_stat[i] = 5 + ((s->base_stat[i] + IV[i]) * 2 * level) / 100;
-    if (i == 0) { // HP
-      effective_stat[i] += 5 + level;
+  for (level = 0; level <= DB_MAX_LEVEL; level++) {
+    for (b = 0; b <= POKEMON_MAX_STAT_BASE; b++) {
+      t.row[level][b] = 5 + (b * 2 * level) / 100;
     }
   }
-  exp = 0;
-  shiny = (((rand() & 0x1fff) == 0x1fff) ? true : false);
-  gender = ((rand() & 0x1) ? gender_female : gender_male);
+
+  return t;
 }
 
+// Worked out by the compiler; there's nothing to build at startup.
+static constexpr stat_table_t stat_table = make_stat_table();
+
+void pokemon::compute_stats()
+{
+  const uint8_t *base = db_species_stats(pokemon_species_index)->base_stat;
+  const uint16_t *row;
+
+  assert(level <= DB_MAX_LEVEL);
+  row = stat_table.row[level];
+
+  effective_stat[stat_hp] = row[base[stat_hp] + get_iv(stat_hp)] + 5 + level;
+  effective_stat[stat_atk] = row[base[stat_atk] + get_iv(stat_atk)];
+  effective_stat[stat_def] = row[base[stat_def] + get_iv(stat_def)];
+  effective_stat[stat_spatk] = row[base[stat_spatk] + get_iv(stat_spatk)];
+  effective_stat[stat_spdef] = row[base[stat_spdef] + get_iv(stat_spdef)];
+  effective_stat[stat_speed] = row[base[stat_speed] + get_iv(stat_speed)];
+}
+
+void generate_pokemon_batch(int count, int minl, int maxl,
+                            class pokemon *out[])
+{
+  int i;
+
+  for (i = 0; i < count; i++) {
+    out[i] = new class pokemon(minl + rng_range(&rng[rng_pokemon],
+                                                maxl - minl + 1));
+  }
+}
 
 const char *pokemon::get_species() const
 {
-  return species[pokemon_species_index].identifier;
+  return db_string(db_species()[pokemon_species_index].identifier);
 }
 
 int pokemon::get_level() const
@@ -130,26 +223,34 @@ int pokemon::get_speed() const
 
 const char *pokemon::get_gender_string() const
 {
-  return gender == gender_female ? "female" : "male";
+  return (flags & POKEMON_FEMALE) ? "female" : "male";
 }
 
 bool pokemon::is_shiny() const
 {
-  return shiny;
+  return flags & POKEMON_SHINY;
 }
 
+/* These are what battles ask for, so they read the hot move table. *
+ * Empty power and accuracy are INT_MAX, as they are in moves[].     */
 int pokemon::get_move_accuracy(int i)
 {
+  int accuracy;
+
   if (i < 4 && move_index[i]) {
-    return moves[move_index[i]].accuracy;
+    accuracy = hot_moves[move_index[i]].accuracy;
+    return accuracy == DB_NULL8 ? INT_MAX : accuracy;
   } else {
     return -1;
   }
 }
 int pokemon::get_move_power(int i)
 {
+  int power;
+
   if (i < 4 && move_index[i]) {
-    return moves[move_index[i]].power;
+    power = hot_moves[move_index[i]].power;
+    return power == DB_NULL8 ? INT_MAX : power;
   } else {
     return -1;
   }
@@ -157,15 +258,39 @@ int pokemon::get_move_power(int i)
 int pokemon::get_move_priority(int i)
 {
   if (i < 4 && move_index[i]) {
-    return moves[move_index[i]].priority;
+    return hot_moves[move_index[i]].priority;
   } else {
     return -1;
   }
 }
+/* What move i's damage is scaled by against target: half again if *
+ * the move shares a type with this pokemon, times how well its type *
+ * hits each of target's.  No move is 0, since it does nothing.      */
+double pokemon::get_move_multiplier(int i, const pokemon *target) const
+{
+  const uint8_t *own, *other;
+  int type, scale;
+
+  if (i >= 4 || !move_index[i]) {
+    return 0;
+  }
+
+  type = hot_moves[move_index[i]].type_id;
+  own = db_species_types(pokemon_species_index);
+  other = db_species_types(target->pokemon_species_index);
+
+  scale = type_efficacy[type][other[0]] * type_efficacy[type][other[1]];
+  if (type && (type == own[0] || type == own[1])) {
+    return scale * 1.5 / 4;
+  }
+
+  return scale / 4.0;
+}
+
 const char *pokemon::get_move(int i) const
 {
   if (i < 4 && move_index[i]) {
-    return moves[move_index[i]].identifier;
+    return db_string(db_moves()[move_index[i]].identifier);
   } else {
     return "";
   }
@@ -190,7 +315,7 @@ void pokemon::learn_move(int move)
   else
   {
     //needs to choose a move to forget. maybe include io.h and have a function that returns the index of the desired move to be forgotten.
-    forgotten_move = io_forget_a_move(get_species(), get_move(0), get_move(1), get_move(2), get_move(3), moves[move_index[index]].identifier);
+    forgotten_move = io_forget_a_move(get_species(), get_move(0), get_move(1), get_move(2), get_move(3), db_string(db_moves()[move].identifier));
     if(forgotten_move != -1)
     {
       move_index[forgotten_move] = move;
@@ -198,33 +323,61 @@ void pokemon::learn_move(int move)
   }
 }
 
-void pokemon::level_up()
+const int *pokemon::growth() const
 {
-  unsigned i;
-  level++;
-  for(i = 0; i < 6; i++)
-  {
-    effective_stat[i] = 5 + ((s->base_stat[i] + IV[i]) * 2 * level) / 100;
-    if (i == 0) effective_stat[i] += 5 + level;
-  }
-  for(i = 0; i < s->levelup_moves.size() && level >= s->levelup_moves[i].level; i++)
-  {
-    if(level == s->levelup_moves[i].level)
-    {
-      learn_move(s->levelup_moves[i].move);
+  return db_growth_exp(db_species_stats(pokemon_species_index)->
+                       growth_rate_id);
+}
+
+/* Moves straight to level to, learning every move on the way in     *
+ * order, and works out the stats once, at the end.                  */
+void pokemon::advance(int to)
+{
+  const levelup_move *lm;
+  int num_lm;
+  int i;
+
+  lm = db_levelup_moves(pokemon_species_index, &num_lm);
+  for (i = 0; i < num_lm && lm[i].level <= to; i++) {
+    if (lm[i].level > level) {
+      learn_move(lm[i].move);
     }
   }
+  level = to;
+  compute_stats();
 }
 
+void pokemon::level_up()
+{
+  if (level < DB_MAX_LEVEL) {
+    exp = growth()[level + 1];
+    advance(level + 1);
+  }
+}
+
+/* exp is the total ever gained, so the new level is just the last   *
+ * one whose threshold it has reached, found by bisecting the growth *
+ * curve above the current level.  No more is gained after the top   *
+ * level.                                                            */
 int pokemon::gain_exp(int xp)
 {
-  int levels_gained = 0;
-  exp += xp;
-  while(exp > 100)
-  {
-    level_up();
-    exp -= 100;
-    levels_gained++;
+  const int *need = growth();
+  int from = level;
+  int lo, hi, mid;
+
+  exp = (exp + xp < need[DB_MAX_LEVEL] ? exp + xp : need[DB_MAX_LEVEL]);
+
+  for (lo = level, hi = DB_MAX_LEVEL + 1; hi - lo > 1; ) {
+    mid = (lo + hi) / 2;
+    if (need[mid] <= exp) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
   }
-  return levels_gained;
+  if (lo > from) {
+    advance(lo);
+  }
+
+  return lo - from;
 }
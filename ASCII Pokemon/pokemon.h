@@ -1,6 +1,9 @@
 #ifndef POKEMON_H
 # define POKEMON_H
 
+# include <cstddef>
+# include <cstdint>
+
 enum pokemon_stat {
   stat_hp,
   stat_atk,
@@ -15,19 +18,38 @@ enum pokemon_gender {
   gender_male
 };
 
+# define POKEMON_SHINY  0x01
+# define POKEMON_FEMALE 0x02
+
+/* Boxes and parties hold a lot of these, so they're packed into 32 *
+ * bytes: stats fit in 16 bits, move and species indices do too, and *
+ * the six 4-bit IVs share one word.  Nothing outside of pokemon.cpp *
+ * sees the layout; use the getters.                                 */
 class pokemon {
  private:
-  int level;
-  int pokemon_index;
-  int move_index[4];
-  int pokemon_species_index;
-  int IV[6];
-  int effective_stat[6];
-  bool shiny;
-  int exp;
-  pokemon_gender gender;
+  uint16_t effective_stat[6];
+  uint16_t move_index[4];
+  uint16_t pokemon_species_index;
+  uint8_t level;
+  uint8_t flags;
+  uint32_t IVs;
+  int32_t exp;
+
+  int get_iv(int stat) const
+  {
+    return (IVs >> (stat * 4)) & 0xf;
+  }
+  void generate(uint64_t r0, uint64_t r1);
+  void pick_moves(uint32_t r);
+  void compute_stats();
+  const int *growth() const;
+  void advance(int to);
  public:
   pokemon(int level);
+  // species is a row of the species table, as encounter_species() gives.
+  pokemon(int level, int species);
+  static void *operator new(size_t size);
+  static void operator delete(void *p);
   const char *get_species() const;
   int get_level() const;
   int get_hp() const;
@@ -41,10 +63,28 @@ class pokemon {
   int get_move_accuracy(int i);
   int get_move_power(int i);
   int get_move_priority(int i);
+  double get_move_multiplier(int i, const pokemon *target) const;
   const char *get_move(int i) const;
   void learn_move(int move);
   void level_up();
   int gain_exp(int exp);
 };
 
+/* Makes count new pokemon into out, with levels uniform in [minl, *
+ * maxl], each by new pokemon(level).                               */
+void generate_pokemon_batch(int count, int minl, int maxl,
+                            class pokemon *out[]);
+
+/* pokemon come from a pool (see operator new in pokemon.cpp).  These *
+ * count what it has done, for checking that steady-state play makes  *
+ * no heap calls: slabs only grows when the pool itself hits the heap. */
+typedef struct pokemon_pool_stats {
+  uint64_t allocs;
+  uint64_t frees;
+  uint64_t live;
+  uint64_t slabs;
+} pokemon_pool_stats_t;
+
+const pokemon_pool_stats_t *pokemon_pool_stats();
+
 #endif
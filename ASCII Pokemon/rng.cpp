@@ -0,0 +1,48 @@
+#include "rng.h"
+
+rng_t rng[num_rng_streams];
+
+static uint32_t base_seed;
+
+// splitmix64, to spread a seed over the whole state.
+static uint64_t rng_splitmix(uint64_t *x)
+{
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+  return z ^ (z >> 31);
+}
+
+void rng_seed(rng_t *r, uint64_t seed)
+{
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    r->s[i] = rng_splitmix(&seed);
+  }
+}
+
+/* Streams are keyed by the seed, the stream and, for maps, where the *
+ * map is.  Coordinates get 12 bits apiece, plenty for the world.     */
+static uint64_t rng_key(int stream, int x, int y)
+{
+  return (((uint64_t) base_seed << 32) | ((uint64_t) stream << 24) |
+          ((uint64_t) (x & 0xfff) << 12) | (y & 0xfff));
+}
+
+void rng_init(uint32_t seed)
+{
+  int i;
+
+  base_seed = seed;
+  for (i = 0; i < num_rng_streams; i++) {
+    rng_seed(&rng[i], rng_key(i, 0xfff, 0xfff));
+  }
+}
+
+void rng_seed_map(int x, int y)
+{
+  rng_seed(&rng[rng_map], rng_key(rng_map, x, y));
+}
@@ -0,0 +1,78 @@
+#ifndef RNG_H
+# define RNG_H
+
+# include <cstdint>
+
+/* xoshiro256** generators, one stream per subsystem, so that what one *
+ * part of the game draws never shifts what another sees.  Every       *
+ * stream is derived from the --seed value; the map stream is reseeded *
+ * from the seed and the world coordinates whenever a map is made, so  *
+ * a given seed always makes the same map at the same place, whatever  *
+ * order the world is explored in.                                     *
+ *                                                                     *
+ * Nothing here locks.  A stream belongs to whoever uses it.           */
+typedef struct rng {
+  uint64_t s[4];
+} rng_t;
+
+enum rng_stream {
+  rng_map,      // Terrain, buildings and trainer placement
+  rng_npc,      // NPC movement
+  rng_pokemon,  // Species, moves, IVs
+  rng_battle,   // Damage, accuracy, catching, rewards
+  rng_world,    // Encounter rolls and other PC-side chance
+  num_rng_streams
+};
+
+extern rng_t rng[num_rng_streams];
+
+void rng_seed(rng_t *r, uint64_t seed);
+// Seeds every stream; main calls it before anything draws.
+void rng_init(uint32_t seed);
+void rng_seed_map(int x, int y);
+
+static inline uint64_t rng_rotl(uint64_t x, int k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rng_next(rng_t *r)
+{
+  uint64_t result = rng_rotl(r->s[1] * 5, 7) * 9;
+  uint64_t t = r->s[1] << 17;
+
+  r->s[2] ^= r->s[0];
+  r->s[3] ^= r->s[1];
+  r->s[1] ^= r->s[2];
+  r->s[0] ^= r->s[3];
+  r->s[2] ^= t;
+  r->s[3] = rng_rotl(r->s[3], 45);
+
+  return result;
+}
+
+// The high bits are the best ones.
+static inline uint32_t rng_u32(rng_t *r)
+{
+  return rng_next(r) >> 32;
+}
+
+/* Uniform in [0, n) by multiplying rather than dividing.  The bias is *
+ * at most n / 2^32, which nothing in the game can notice.             */
+static inline uint32_t rng_below(uint32_t x, uint32_t n)
+{
+  return ((uint64_t) x * n) >> 32;
+}
+
+static inline int rng_range(rng_t *r, int n)
+{
+  return rng_below(rng_u32(r), n);
+}
+
+// True p percent of the time.
+static inline bool rng_percent(rng_t *r, int p)
+{
+  return rng_range(r, 100) < p;
+}
+
+#endif
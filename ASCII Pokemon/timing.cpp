@@ -0,0 +1,176 @@
+#include <cstring>
+#include <ctime>
+
+#include "timing.h"
+
+#define TIMING_MAX_PHASES 128
+#define TIMING_MAX_DEPTH  16
+
+typedef struct timing_phase {
+  const char *name;
+  int parent;
+  int64_t calls;
+  int64_t ns;
+  int64_t rows;
+  int64_t bytes;
+} timing_phase_t;
+
+bool timing_enabled;
+
+static timing_phase_t phase[TIMING_MAX_PHASES];
+static int num_phases;
+
+// The open phases, innermost last, and when each was begun.
+static int open_phase[TIMING_MAX_DEPTH];
+static int64_t open_time[TIMING_MAX_DEPTH];
+static int depth;
+
+void timing_enable()
+{
+  timing_enabled = true;
+}
+
+int64_t timing_now()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Finds the named child of parent, adding it if it's new.  Returns -1 *
+ * when the table is full; those phases just aren't recorded.          */
+static int timing_find(int parent, const char *name)
+{
+  int i;
+
+  for (i = 0; i < num_phases; i++) {
+    if (phase[i].parent == parent && !strcmp(phase[i].name, name)) {
+      return i;
+    }
+  }
+  if (num_phases == TIMING_MAX_PHASES) {
+    return -1;
+  }
+  phase[num_phases].name = name;
+  phase[num_phases].parent = parent;
+
+  return num_phases++;
+}
+
+static int timing_current()
+{
+  return depth ? open_phase[depth - 1] : -1;
+}
+
+int timing_begin_phase(const char *name)
+{
+  int p;
+
+  if (depth == TIMING_MAX_DEPTH || (p = timing_find(timing_current(),
+                                                    name)) < 0) {
+    return -1;
+  }
+  open_phase[depth] = p;
+  open_time[depth++] = timing_now();
+
+  return p;
+}
+
+/* Ends the phase, and anything still open inside of it.  A phase that *
+ * isn't open is ignored.                                              */
+void timing_end_phase(int p)
+{
+  int64_t now = timing_now();
+  int d;
+
+  for (d = depth - 1; d >= 0 && open_phase[d] != p; d--)
+    ;
+  if (d < 0) {
+    return;
+  }
+  while (depth > d) {
+    depth--;
+    phase[open_phase[depth]].calls++;
+    phase[open_phase[depth]].ns += now - open_time[depth];
+  }
+}
+
+void timing_count(int p, int64_t rows, int64_t bytes)
+{
+  if (p >= 0) {
+    phase[p].rows += rows;
+    phase[p].bytes += bytes;
+  }
+}
+
+void timing_record(const char *name, int64_t ns, int64_t rows, int64_t bytes)
+{
+  int p;
+
+  if (timing_enabled && (p = timing_find(timing_current(), name)) >= 0) {
+    phase[p].calls++;
+    phase[p].ns += ns;
+    phase[p].rows += rows;
+    phase[p].bytes += bytes;
+  }
+}
+
+static void timing_report_children(FILE *f, int parent, int indent)
+{
+  int i;
+
+  for (i = 0; i < num_phases; i++) {
+    if (phase[i].parent != parent) {
+      continue;
+    }
+    fprintf(f, "%*s%-*s %10.3fms %7ld",
+            indent, "", 32 - indent, phase[i].name,
+            phase[i].ns / 1e6, (long) phase[i].calls);
+    if (phase[i].rows || phase[i].bytes) {
+      fprintf(f, " %9ld %11ld", (long) phase[i].rows, (long) phase[i].bytes);
+    }
+    fputc('\n', f);
+    timing_report_children(f, i, indent + 2);
+  }
+}
+
+void timing_report(FILE *f)
+{
+  fprintf(f, "%-32s %12s %7s %9s %11s\n",
+          "phase", "time", "calls", "rows", "bytes");
+  timing_report_children(f, -1, 0);
+}
+
+static void timing_report_json_children(FILE *f, int parent, int indent)
+{
+  bool first;
+  int i;
+
+  fputc('[', f);
+  for (first = true, i = 0; i < num_phases; i++) {
+    if (phase[i].parent != parent) {
+      continue;
+    }
+    fprintf(f, "%s\n%*s{ \"name\": \"%s\", \"ns\": %ld, \"calls\": %ld, "
+            "\"rows\": %ld, \"bytes\": %ld, \"children\": ",
+            first ? "" : ",", indent + 2, "", phase[i].name,
+            (long) phase[i].ns, (long) phase[i].calls,
+            (long) phase[i].rows, (long) phase[i].bytes);
+    timing_report_json_children(f, i, indent + 2);
+    fputs(" }", f);
+    first = false;
+  }
+  if (!first) {
+    fprintf(f, "\n%*s", indent, "");
+  }
+  fputc(']', f);
+}
+
+void timing_report_json(FILE *f)
+{
+  fputs("{ \"phases\": ", f);
+  timing_report_json_children(f, -1, 0);
+  fputs(" }\n", f);
+}
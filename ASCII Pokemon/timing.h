@@ -0,0 +1,52 @@
+#ifndef TIMING_H
+# define TIMING_H
+
+# include <cstdio>
+# include <cstdint>
+
+/* Phase timers for seeing where startup and map generation go, *
+ * reported at exit by --timings.  Phases nest: one begun while  *
+ * another is open becomes its child.  Runs of a phase with the  *
+ * same name under the same parent are added together, so a      *
+ * phase inside a loop shows up once, with a call count.  Names  *
+ * are kept, not copied, so they have to be string literals or   *
+ * otherwise live forever.                                       *
+ *                                                               *
+ * Timing is off until timing_enable() is called, and until then *
+ * timing_begin() and timing_end() are a test and a branch.      *
+ * Only the main thread may begin and end phases.                */
+
+extern bool timing_enabled;
+
+void timing_enable();
+
+// Monotonic time in nanoseconds.
+int64_t timing_now();
+
+int timing_begin_phase(const char *name);
+void timing_end_phase(int phase);
+
+// Returns a handle for timing_end() and timing_count().
+static inline int timing_begin(const char *name)
+{
+  return timing_enabled ? timing_begin_phase(name) : -1;
+}
+
+static inline void timing_end(int phase)
+{
+  if (phase >= 0) {
+    timing_end_phase(phase);
+  }
+}
+
+// Credits a phase with rows (or whatever it's counting) and bytes read.
+void timing_count(int phase, int64_t rows, int64_t bytes);
+
+/* Adds a run of a child of the current phase that was timed elsewhere, *
+ * such as on a worker thread.                                          */
+void timing_record(const char *name, int64_t ns, int64_t rows, int64_t bytes);
+
+void timing_report(FILE *f);
+void timing_report_json(FILE *f);
+
+#endif